@@ -1,6 +1,24 @@
+#include "../common/bench.h"
+#include "../common/generate.h"
+#include "../common/line_stream.h"
+#include "../common/parallel.h"
+#include "../common/parse_number.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+#include "../common/verify.h"
+
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 using u_int = unsigned int;
@@ -10,19 +28,25 @@ using namespace std;
 constexpr char LEFT = 'L';
 constexpr char RIGHT = 'R';
 
+// where the dial points & the count so far. Passed along so the rotations can also come in chunks (--stream)
+struct Dial {
+	int position;
+	u_int result = 0;
+};
+
 // Part 1
 // iterate through the directives
 // will have to account for left & right turns. easiest is to convert everything
 // into a right turn by doing (right_turn = lock_max + 1 - left_turn)
 // mod must happen first, so that its in the range of 0-lock_max
-u_int find_num_times_land_on_zero(const vector<string>& lines, const int start_position, const int lock_max) {
+void land_on_zero(Dial& dial, const vector<string_view>& lines, const int lock_max) {
 	const int num_lock_ticks = lock_max + 1;
-	int curr = start_position;
-	int result = 0;
+	int curr = dial.position;
+	u_int result = dial.result;
 
 	for (const auto& line : lines) {
 		const char direction = line[0];
-		int value = stoi(line.substr(1)) % num_lock_ticks;
+		int value = parse_int<int>(line.substr(1)) % num_lock_ticks;
 		if (LEFT == direction) {
 			value = num_lock_ticks - value;
 		}
@@ -33,7 +57,7 @@ u_int find_num_times_land_on_zero(const vector<string>& lines, const int start_p
 		}
 	}
 
-	return result;
+	dial = Dial{curr, result};
 }
 
 // Part 2
@@ -49,17 +73,14 @@ u_int find_num_times_land_on_zero(const vector<string>& lines, const int start_p
 // Say you land on 0 on one Left iteration & count this value. If you then
 // have another left, you cannot count this value again.
 // So you need to check this edge case.
-u_int find_num_times_cross_zero(
-	const vector<string>& lines,
-	const u_int start_position,
-	const u_int lock_max) {
+void cross_zero(Dial& dial, const vector<string_view>& lines, const u_int lock_max) {
 	const u_int num_lock_ticks = lock_max + 1;
-	u_int result = 0;
-	int curr_position = start_position;
+	u_int result = dial.result;
+	int curr_position = dial.position;
 
 	for (const auto& line : lines) {
 		const char direction = line[0];
-		int increment = stoi(line.substr(1));
+		int increment = parse_int<int>(line.substr(1));
 		// revolutions handling
 		result += (increment / num_lock_ticks);
 		increment = increment % num_lock_ticks;
@@ -85,27 +106,387 @@ u_int find_num_times_cross_zero(
 		}
 	}
 
-	return result;
+	dial = Dial{curr_position, result};
 }
 
-int solve(vector<string>& input) {
-	cout << "Part 1 : result=" << find_num_times_land_on_zero(input, 50, 99) << "\n";
-	cout << "Part 2 : result=" << find_num_times_cross_zero(input, 50, 99) << "\n";
+// Both parts in one pass, with no branch on the rotations
+// where the dial points & the counts of both parts so far
+struct DialCounts {
+	u_int position;
+	u_int landings = 0;	 // part 1
+	u_int crossings = 0; // part 2
+};
+
+constexpr size_t DIAL_BLOCK = 256;
+
+// a lock size known at compile time, 0..LOCK_MAX. Passed instead of a u_int lock_max, it turns every
+// / and % by the number of ticks into a multiply & shift
+template <u_int LOCK_MAX>
+using FixedLockMax = integral_constant<u_int, LOCK_MAX>;
+
+// "L68" -> -68, "R5" -> 5
+inline int parse_rotation(const string_view line) {
+	const int magnitude = parse_int<int>(line.substr(1));
+	return LEFT == line[0] ? -magnitude : magnitude;
 }
 
-void get_input_as_vector(vector<string>& input_lines) {
-	string line;
-	while (getline(cin, line)) {
-		input_lines.push_back(line);
+/**
+ * @brief parse_rotation of one line, from a single unaligned 8-byte load at its start: the direction
+ *        is shifted out, the digits are right aligned over '0's, and the 8 digit bytes of the word are
+ *        checked and converted together (SWAR across the digits, see parse_number.h). Still one
+ *        rotation per load. The load runs past the end of the line, so the caller makes sure the
+ *        8 bytes are all in the input.
+ */
+inline int parse_rotation_eight(const string_view line) {
+	if (endian::native != endian::little || line.size() < 2 || line.size() > 8) {
+		return parse_rotation(line);
+	}
+	uint64_t word;
+	memcpy(&word, line.data(), sizeof(word));
+	const size_t pad_bits = (9 - line.size()) * 8;
+	word = (word >> 8) << pad_bits | 0x3030303030303030 >> (64 - pad_bits);
+	const char* const digits = reinterpret_cast<const char*>(&word);
+	if (!is_eight_digits(digits)) {
+		return parse_rotation(line); // a '\r' say, which parse_int stops at, or an invalid line it throws on
 	}
+	const int magnitude = static_cast<int>(parse_eight_digits(digits));
+	return LEFT == line[0] ? -magnitude : magnitude;
 }
 
-int main() {
-	vector<string> input_lines;
-	get_input_as_vector(input_lines);
+// whether lines [begin, end) follow each other in one buffer, each right after the previous newline
+inline bool are_contiguous(const vector<string_view>& lines, const size_t begin, const size_t end) {
+	bool contiguous = true;
+	for (size_t i = begin + 1; i < end; ++i) {
+		contiguous &= lines[i].data() == lines[i - 1].data() + lines[i - 1].size() + 1;
+	}
+	return contiguous;
+}
 
-	if (0 != solve(input_lines)) {
-		return EXIT_FAILURE;
+/**
+ * @brief Turns the dial by one parsed rotation, with no branch on the direction. The whole
+ *        revolutions are zeros passed whatever the position, and only the remaining turn
+ *        (-lock_max..lock_max) decides the rest: right past lock_max, or left onto / past 0 from
+ *        somewhere else than 0. The division only depends on the rotation, so it stays off the
+ *        dependency chain from one rotation to the next, which is an add and a few selects.
+ */
+inline void rotate(DialCounts& dial, const int delta, const u_int num_lock_ticks) {
+	const u_int magnitude = abs(delta);
+	const u_int whole = magnitude / num_lock_ticks;
+	const int turn = magnitude - whole * num_lock_ticks;
+	const int ticks = num_lock_ticks;
+	const int position = dial.position;
+	const int next = position + (delta < 0 ? -turn : turn);
+	dial.crossings += whole + ((next >= ticks) | ((next <= 0) & (0 != position) & (0 != turn)));
+	dial.position = next < 0 ? next + ticks : next >= ticks ? next - ticks : next;
+	dial.landings += 0 == dial.position;
+}
+
+/**
+ * @brief on_rotation(delta) for every line of [begin, end), DIAL_BLOCK lines at a time: in a block
+ *        that is one run of the input buffer, every rotation that starts 8 bytes before the end of the
+ *        block is parsed from its own 8-byte load (parse_rotation_eight).
+ */
+template <typename FRotation>
+inline void for_each_rotation(
+	const vector<string_view>& lines,
+	const size_t begin,
+	const size_t end,
+	FRotation&& on_rotation) {
+	for (size_t block = begin; block < end; block += DIAL_BLOCK) {
+		const size_t block_end = min(block + DIAL_BLOCK, end);
+		const char* const last_byte = lines[block_end - 1].data() + lines[block_end - 1].size();
+		const bool contiguous = are_contiguous(lines, block, block_end);
+		for (size_t i = block; i < block_end; ++i) {
+			const string_view line = lines[i];
+			const bool whole_load = contiguous && line.data() + 8 <= last_byte;
+			on_rotation(whole_load ? parse_rotation_eight(line) : parse_rotation(line));
+		}
 	}
-	return EXIT_SUCCESS;
 }
+
+// Both counts over all the lines, on the calling thread. land_on_zero / cross_zero stay as the
+// references (`--verify`). No allocation.
+template <typename LockMax>
+void rotate_dial(DialCounts& counts, const vector<string_view>& lines, const LockMax lock_max) {
+	const u_int num_lock_ticks = lock_max + 1;
+	DialCounts dial = counts; // a local, which the char loads of the lines cannot alias
+	for_each_rotation(lines, 0, lines.size(), [&](const int delta) { rotate(dial, delta, num_lock_ticks); });
+	counts = dial;
+}
+
+// Both parts on all threads
+// The dial only ever depends on the rotations before it through its position, so a run of rotations
+// is a function of the position it starts from: where it leaves the dial, and the zeros it counts on
+// the way. The runs are summarised independently, and the summaries composed in order, which is the
+// exclusive scan of the start positions of the runs.
+struct DialTransform {
+	u_int net = 0;			 // the dial ends at (start + net) % N
+	vector<u_int> landings;	 // by start position, 0..N-1
+	vector<u_int> crossings; // by start position, 0..N-1
+
+	static DialTransform identity(const u_int num_lock_ticks) {
+		return DialTransform{0, vector<u_int>(num_lock_ticks), vector<u_int>(num_lock_ticks)};
+	}
+};
+
+// the rotations of `first`, then the ones of `second`. O(N)
+DialTransform compose(DialTransform first, const DialTransform& second) {
+	const u_int num_lock_ticks = first.landings.size();
+	for (u_int start = 0; start < num_lock_ticks; ++start) {
+		const u_int middle = (start + first.net) % num_lock_ticks;
+		first.landings[start] += second.landings[middle];
+		first.crossings[start] += second.crossings[middle];
+	}
+	first.net = (first.net + second.net) % num_lock_ticks;
+	return first;
+}
+
+/**
+ * @brief The summary of lines [begin, end), for every start position at once, in one pass.
+ *        With s the sum of the turns so far (mod N), a run that starts at p is at (p + s) % N:
+ *        - it lands on 0 after a rotation for the one p = -s, a histogram of s.
+ *        - a turn t right from there passes 0 for the t starts with (p + s) % N >= N - t, a turn t
+ *          left for the t starts with 1 <= (p + s) % N <= t. Either way a cyclic interval of starts,
+ *          marked in a difference array over 2N (it may wrap once), and folded back at the end.
+ *        - whole revolutions pass 0 from every start.
+ *        So O(1) per rotation, with no branch on it, and O(N) per run.
+ */
+template <typename LockMax>
+DialTransform summarize_rotations(
+	const vector<string_view>& lines,
+	const size_t begin,
+	const size_t end,
+	const LockMax lock_max) {
+	const u_int num_lock_ticks = lock_max + 1;
+	const int ticks = num_lock_ticks;
+	vector<u_int> ends_at(num_lock_ticks);
+	vector<int> starts_passing(2 * num_lock_ticks + 1);
+	u_int revolutions = 0;
+	int sum = 0;
+	for_each_rotation(lines, begin, end, [&](const int delta) {
+		const u_int magnitude = abs(delta);
+		const u_int whole = magnitude / num_lock_ticks;
+		const int turn = magnitude - whole * num_lock_ticks;
+		revolutions += whole;
+
+		int first = delta < 0 ? 1 - sum : ticks - turn - sum;
+		first += first < 0 ? ticks : 0;
+		++starts_passing[first];
+		--starts_passing[first + turn];
+
+		const int next = sum + (delta < 0 ? -turn : turn);
+		sum = next < 0 ? next + ticks : next >= ticks ? next - ticks : next;
+		++ends_at[sum];
+	});
+
+	DialTransform transform = DialTransform::identity(num_lock_ticks);
+	transform.net = sum;
+	int passing = 0;
+	for (int p = 0; p < 2 * ticks; ++p) {
+		passing += starts_passing[p];
+		transform.crossings[p % ticks] += passing;
+	}
+	for (int p = 0; p < ticks; ++p) {
+		transform.landings[p] = ends_at[(ticks - p) % ticks];
+		transform.crossings[p] += revolutions;
+	}
+	return transform;
+}
+
+// below this many rotations per run, the O(N) summaries are not worth it
+constexpr size_t DIAL_SCAN_GRAIN = 1 << 14;
+
+// the summary of all the lines, the runs of DIAL_SCAN_GRAIN rotations (or more, for wide dials)
+// summarised on all threads, and composed in order
+template <typename LockMax>
+DialTransform summarize_dial(const vector<string_view>& lines, const LockMax lock_max) {
+	const u_int num_lock_ticks = lock_max + 1;
+	return parallel_reduce(
+		lines.size(),
+		max<size_t>(DIAL_SCAN_GRAIN, num_lock_ticks),
+		DialTransform::identity(num_lock_ticks),
+		[&](const size_t begin, const size_t end) {
+			return summarize_rotations(lines, begin, end, lock_max);
+		},
+		[](DialTransform first, const DialTransform& second) { return compose(std::move(first), second); });
+}
+
+/**
+ * @brief Both counts from start_position, with the runs of rotations summarised on all threads
+ *        (summarize_dial). With a single thread, few rotations or a dial larger than a run, it is
+ *        simply rotate_dial.
+ */
+template <typename LockMax>
+DialCounts count_dial(const vector<string_view>& lines, const u_int start_position, const LockMax lock_max) {
+	const u_int num_lock_ticks = lock_max + 1;
+	if (1 == thread_count() || lines.size() < 2 * DIAL_SCAN_GRAIN || num_lock_ticks > DIAL_SCAN_GRAIN) {
+		DialCounts dial{start_position};
+		rotate_dial(dial, lines, lock_max);
+		return dial;
+	}
+
+	const DialTransform total = summarize_dial(lines, lock_max);
+	return DialCounts{
+		(start_position + total.net) % num_lock_ticks,
+		total.landings[start_position],
+		total.crossings[start_position]};
+}
+
+/**
+ * @brief Both counts from every start position 0..LOCK_MAX, for audits. One summary of the
+ *        rotations (on all threads for long inputs) answers them all, where counting from each start
+ *        in turn would take LOCK_MAX + 1 passes.
+ */
+template <u_int LOCK_MAX>
+array<DialCounts, LOCK_MAX + 1> count_dial_from_every_start(const vector<string_view>& lines) {
+	const DialTransform total = summarize_dial(lines, FixedLockMax<LOCK_MAX>{});
+	array<DialCounts, LOCK_MAX + 1> counts;
+	for (u_int start = 0; start <= LOCK_MAX; ++start) {
+		counts[start] =
+			DialCounts{(start + total.net) % (LOCK_MAX + 1), total.landings[start], total.crossings[start]};
+	}
+	return counts;
+}
+
+u_int find_num_times_land_on_zero(
+	const vector<string_view>& lines,
+	const u_int start_position,
+	const u_int lock_max) {
+	return count_dial(lines, start_position, lock_max).landings;
+}
+
+u_int find_num_times_cross_zero(
+	const vector<string_view>& lines,
+	const u_int start_position,
+	const u_int lock_max) {
+	return count_dial(lines, start_position, lock_max).crossings;
+}
+
+// both parts come out of the same pass over the rotations
+int solve(const vector<string_view>& input, ostream& out) {
+	const DialCounts dial =
+		time_phase("rotate", [&input] { return count_dial(input, 50, FixedLockMax<99>{}); });
+	out << "Part 1 : result=" << dial.landings << "\n";
+	out << "Part 2 : result=" << dial.crossings << "\n";
+	return 0;
+}
+
+// both parts in one pass over the rotations, as they are read
+int solve_stream(LineStream& stream, ostream& out) {
+	ScopedPhase phase("stream");
+	DialCounts dial{50};
+	vector<string_view> lines;
+	while (stream.next(lines)) {
+		rotate_dial(dial, lines, FixedLockMax<99>{});
+	}
+	out << "Part 1 : result=" << dial.landings << "\n";
+	out << "Part 2 : result=" << dial.crossings << "\n";
+	return 0;
+}
+
+// scale rotations of 1..999 ticks in either direction
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	for (size_t i = 0; i < scale; ++i) {
+		os << (random_chance(rng, 0.5) ? LEFT : RIGHT) << random_between(rng, 1, 999) << '\n';
+	}
+}
+
+// the rotation at a time versions, from 50 on a 0..99 dial
+u_int land_on_zero_reference(const vector<string_view>& input) {
+	Dial dial{50};
+	land_on_zero(dial, input, 99);
+	return dial.result;
+}
+
+u_int cross_zero_reference(const vector<string_view>& input) {
+	Dial dial{50};
+	cross_zero(dial, input, 99);
+	return dial.result;
+}
+
+// the final position & both counts from every start, "position:landings/crossings" each
+string describe_every_start(const array<DialCounts, 100>& counts) {
+	string text;
+	for (const DialCounts& dial : counts) {
+		text += to_string(dial.position) + ":" + to_string(dial.landings) + "/" + to_string(dial.crossings);
+		text += " ";
+	}
+	return text;
+}
+
+// two passes of the rotation at a time versions from each start, independent of every fast path
+array<DialCounts, 100> count_dial_from_every_start_reference(const vector<string_view>& input) {
+	array<DialCounts, 100> counts;
+	for (u_int start = 0; start < counts.size(); ++start) {
+		Dial landing{static_cast<int>(start)};
+		land_on_zero(landing, input, 99);
+		Dial crossing{static_cast<int>(start)};
+		cross_zero(crossing, input, 99u);
+		counts[start] = DialCounts{static_cast<u_int>(landing.position), landing.result, crossing.result};
+	}
+	return counts;
+}
+
+// parsing happens inline with the rotations, so there is no separate parse phase
+void benchmark(Benchmark& bench, const vector<string_view>& input) {
+	bench.run("rotate", [&input] {
+		const DialCounts dial = count_dial(input, 50, FixedLockMax<99>{});
+		return dial.landings + dial.crossings;
+	});
+	bench.run_allocation_free("rotate/sequential", [&input] {
+		DialCounts dial{50};
+		rotate_dial(dial, input, FixedLockMax<99>{});
+		return dial.landings + dial.crossings;
+	});
+	bench.run_allocation_free("rotate/runtime_lock", [&input] {
+		DialCounts dial{50};
+		rotate_dial(dial, input, 99u);
+		return dial.landings + dial.crossings;
+	});
+	bench.run_allocation_free("part_1/reference", [&input] { return land_on_zero_reference(input); });
+	bench.run_allocation_free("part_2/reference", [&input] { return cross_zero_reference(input); });
+
+	bench.run("every_start", [&input] { return count_dial_from_every_start<99>(input)[0].crossings; });
+	bench.run_allocation_free("every_start/reference", [&input] {
+		return count_dial_from_every_start_reference(input)[0].crossings;
+	});
+}
+
+void verify(Verifier& verifier, const vector<string_view>& input) {
+	verifier.check(
+		"part_1",
+		[&input] { return land_on_zero_reference(input); },
+		[&input] { return find_num_times_land_on_zero(input, 50, 99); });
+	verifier.check(
+		"part_2",
+		[&input] { return cross_zero_reference(input); },
+		[&input] { return find_num_times_cross_zero(input, 50, 99); });
+	verifier.check(
+		"every_start",
+		[&input] { return describe_every_start(count_dial_from_every_start_reference(input)); },
+		[&input] { return describe_every_start(count_dial_from_every_start<99>(input)); });
+
+	// the summaries of two halves composed, whatever the thread count
+	verifier.check(
+		"scan",
+		[&input] { return describe_every_start(count_dial_from_every_start_reference(input)); },
+		[&input] {
+			const size_t middle = input.size() / 2;
+			const DialTransform total = compose(
+				summarize_rotations(input, 0, middle, 99u),
+				summarize_rotations(input, middle, input.size(), 99u));
+			array<DialCounts, 100> counts;
+			for (u_int start = 0; start < counts.size(); ++start) {
+				counts[start] =
+					DialCounts{(start + total.net) % 100, total.landings[start], total.crossings[start]};
+			}
+			return describe_every_start(counts);
+		});
+}
+
+const RegisterSolver registered{
+	{2025, 1, "Secret Entrance", solve, benchmark, generate_input, solve_stream, nullptr, nullptr, verify}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
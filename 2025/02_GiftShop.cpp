@@ -1,10 +1,21 @@
+#include "../common/bench.h"
+#include "../common/generate.h"
+#include "../common/parallel.h"
+#include "../common/parse_number.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+#include "../common/verify.h"
+
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <functional>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -68,10 +79,61 @@ u_ll get_number_double_repeat_between(const u_ll start, const u_ll end) {
 	return result;
 }
 
-u_ll get_total_double_repeats(vector<Range>& ranges) {
+// 10^0 .. 10^19, every power of 10 a u_ll holds
+constexpr array<u_ll, 20> POWERS_OF_10 = [] {
+	array<u_ll, 20> powers{};
+	u_ll power = 1;
+	for (u_ll& p : powers) {
+		p = power;
+		power *= 10;
+	}
+	return powers;
+}();
+
+// first + (first + 1) + ... + last, wrapping like any u_ll sum: whichever factor is even is halved first
+inline u_ll sum_between(const u_ll first, const u_ll last) {
+	u_ll count = last - first + 1;
+	u_ll total = first + last;
+	(0 == count % 2 ? count : total) /= 2;
+	return count * total;
+}
+
+/**
+ * @brief The sum of the numbers in [start, end] made of one block of block_digits digits repeated
+ *        n_blocks times. They are y * (1 + 10^b + 10^2b + ...) for the b digit blocks y, so the ones
+ *        in range are a run of consecutive y, summed as an arithmetic series. O(n_blocks).
+ *        Expects n_blocks >= 2.
+ */
+u_ll sum_repeated_blocks(const u_ll start, const u_ll end, const u_int block_digits, const u_int n_blocks) {
+	if (block_digits * n_blocks > 20) {
+		return 0; // more digits than any u_ll
+	}
+	u_ll repeat = 0; // 1 + 10^b + ..., at most 11...1 (20 ones), which fits
+	for (u_int i = 0; i < n_blocks; ++i) {
+		repeat = repeat * POWERS_OF_10[block_digits] + 1;
+	}
+	const u_ll first = max(POWERS_OF_10[block_digits - 1], start / repeat + (0 != start % repeat));
+	const u_ll last = min(POWERS_OF_10[block_digits] - 1, end / repeat);
+	return first <= last ? repeat * sum_between(first, last) : 0;
+}
+
+/**
+ * @brief Same sum as get_number_double_repeat_between, in closed form: the doubled numbers with a k
+ *        digit half are x * (10^k + 1), one arithmetic series per k. O(digits) per range, however
+ *        wide. get_number_double_repeat_between stays as its reference (`--verify`).
+ */
+u_ll sum_double_repeats_between(const u_ll start, const u_ll end) {
 	u_ll result = 0;
-	for (Range& range : ranges) {
-		result += get_number_double_repeat_between(range.first, range.second);
+	for (u_int half = 1; 2 * half <= POWERS_OF_10.size(); ++half) {
+		result += sum_repeated_blocks(start, end, half, 2);
+	}
+	return result;
+}
+
+u_ll get_total_double_repeats(const vector<Range>& ranges) {
+	u_ll result = 0;
+	for (const Range& range : ranges) {
+		result += sum_double_repeats_between(range.first, range.second);
 	}
 	return result;
 }
@@ -120,72 +182,168 @@ u_ll get_periodic_repeats_between(const u_ll start, const u_ll end) {
 	return result;
 }
 
-u_ll get_total_periodic_repeats(vector<Range>& ranges) {
+// μ(n): 0 if a square divides n, else -1 to the number of its prime factors
+constexpr int mobius(u_int n) {
+	int result = 1;
+	for (u_int p = 2; p * p <= n; ++p) {
+		if (0 == n % p) {
+			n /= p;
+			if (0 == n % p) {
+				return 0;
+			}
+			result = -result;
+		}
+	}
+	return n > 1 ? -result : result;
+}
+
+/**
+ * @brief Same sum as get_periodic_repeats_between, with nothing enumerated. A number of L digits has
+ *        period d (d | L, d < L) when it is a d digit block repeated L / d times, and the numbers with
+ *        periods d and e are the ones with period gcd(d, e). So by inclusion–exclusion over the
+ *        divisors of L (Möbius inversion), the numbers with some period sum to
+ *
+ *            -sum over d | L, d < L of  μ(L / d) * S(d)
+ *
+ *        S(d) being the sum of the ones with period d (sum_repeated_blocks), and each number counts
+ *        once, with no set to dedupe through. The u_ll sums wrap like the brute force ones would.
+ *        get_periodic_repeats_between stays as its reference (`--verify`).
+ *
+ *        Time : O(digits * divisors * digits) per range, no allocation
+ */
+u_ll sum_periodic_between(const u_ll start, const u_ll end) {
 	u_ll result = 0;
-	for (Range& range : ranges) {
-		result += get_periodic_repeats_between(range.first, range.second);
+	for (u_int digits = max(2u, get_power(start) + 1); digits <= get_power(end) + 1; ++digits) {
+		for (u_int period = 1; period < digits; ++period) {
+			const int coefficient = 0 == digits % period ? -mobius(digits / period) : 0;
+			if (0 == coefficient)
+				continue;
+			const u_ll sum = sum_repeated_blocks(start, end, period, digits / period);
+			result += coefficient > 0 ? sum : 0 - sum;
+		}
+	}
+	return result;
+}
+
+u_ll sum_periodic_ranges(const vector<Range>& ranges, const size_t begin, const size_t end) {
+	u_ll result = 0;
+	for (size_t i = begin; i < end; ++i) {
+		result += sum_periodic_between(ranges[i].first, ranges[i].second);
 	}
 	return result;
 }
 
-void time_wrap(function<void(vector<Range>&)> func, vector<Range>& input) {
-	auto start = std::chrono::high_resolution_clock::now();
-	func(input);
-	auto end = std::chrono::high_resolution_clock::now();
-	std::chrono::duration<double> elapsed = end - start;
-	cout << "time_seconds=" << elapsed.count() << "\n";
+// every range is a few closed form series now, so they only go parallel by the thousands, and the
+// trace shows a task per chunk of ranges (indexed by its first range) instead of one per range
+u_ll get_total_periodic_repeats(const vector<Range>& ranges) {
+	return parallel_reduce(
+		ranges.size(),
+		4096,
+		u_ll{0},
+		[&ranges](const size_t begin, const size_t end) {
+			ScopedTask task("ranges", begin);
+			return sum_periodic_ranges(ranges, begin, end);
+		},
+		plus<u_ll>{});
 }
 
-void parse_input(vector<Range>& result, const string& input) {
+void parse_input(vector<Range>& result, const string_view input) {
 	size_t start = 0;
 	while (start < input.size()) {
 		size_t i_dash = input.find('-', start);
 		size_t i_comma = input.find(',', start);
-		if (i_dash == string::npos)
+		if (i_dash == string_view::npos)
 			break;
 
-		size_t end_pos = (i_comma == string::npos) ? input.size() : i_comma;
+		size_t end_pos = (i_comma == string_view::npos) ? input.size() : i_comma;
 		result.emplace_back(
 			Range{
-				stoull(input.substr(start, i_dash - start)),
-				stoull(input.substr(i_dash + 1, end_pos - i_dash - 1))});
+				parse_uint<u_ll>(input.substr(start, i_dash - start)),
+				parse_uint<u_ll>(input.substr(i_dash + 1, end_pos - i_dash - 1))});
 
-		start = (i_comma == string::npos) ? input.size() : i_comma + 1;
+		start = (i_comma == string_view::npos) ? input.size() : i_comma + 1;
 	}
 }
 
-int solve(const vector<string>& input_lines) {
+int solve(const vector<string_view>& input_lines, ostream& out) {
 	vector<Range> ranges;
-	parse_input(ranges, input_lines[0]);
+	time_phase("parse", [&] {
+		parse_input(ranges, input_lines[0]);
+		return ranges.size();
+	});
 
-	auto solve_1 = [](vector<Range>& ranges) {
-		u_ll result = get_total_double_repeats(ranges);
-		std::cout << "Part 1 : get_number_double_repeat_between=" << result << "\n";
-	};
-	time_wrap(solve_1, ranges);
+	const u_ll result_1 = time_phase("part_1", [&ranges] { return get_total_double_repeats(ranges); });
+	out << "Part 1 : get_total_double_repeats=" << result_1 << "\n";
 
-	auto solve_2 = [](vector<Range>& ranges) {
-		u_ll result = get_total_periodic_repeats(ranges);
-		std::cout << "Part 2 : get_total_periodic_repeats=" << result << "\n";
-	};
-	time_wrap(solve_2, ranges);
+	const u_ll result_2 = time_phase("part_2", [&ranges] { return get_total_periodic_repeats(ranges); });
+	out << "Part 2 : get_total_periodic_repeats=" << result_2 << "\n";
 
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input_lines) {
-	string line;
-	while (getline(cin, line)) {
-		input_lines.push_back(line);
+// a single line of scale comma separated ranges. Ids have 1 to 10 digits and ranges
+// are at most ~1% of their magnitude wide, so they stay within one or two digit lengths
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	for (size_t i = 0; i < scale; ++i) {
+		const u_int digits = random_between(rng, 1, 10);
+		const u_ll lo = digits == 1 ? 1 : static_cast<u_ll>(pow(10, digits - 1));
+		const u_ll start = random_between(rng, lo, lo * 10 - 1);
+		const u_ll end = start + random_between(rng, 0, max<u_ll>(10, start / 100));
+		os << (i ? "," : "") << start << '-' << end;
 	}
+	os << '\n';
 }
 
-int main() {
-	vector<string> input_lines;
-	get_input_as_vector(input_lines);
+u_ll get_total_double_repeats_reference(const vector<Range>& ranges) {
+	u_ll result = 0;
+	for (const Range& range : ranges) {
+		result += get_number_double_repeat_between(range.first, range.second);
+	}
+	return result;
+}
 
-	if (0 != solve(input_lines)) {
-		return EXIT_FAILURE;
+u_ll get_total_periodic_repeats_reference(const vector<Range>& ranges) {
+	u_ll result = 0;
+	for (const Range& range : ranges) {
+		result += get_periodic_repeats_between(range.first, range.second);
 	}
-	return EXIT_SUCCESS;
+	return result;
 }
+
+void benchmark(Benchmark& bench, const vector<string_view>& input_lines) {
+	bench.run("parse", [&input_lines] {
+		vector<Range> ranges;
+		parse_input(ranges, input_lines[0]);
+		return ranges.size();
+	});
+
+	vector<Range> ranges;
+	parse_input(ranges, input_lines[0]);
+	bench.run_allocation_free("part_1", [&ranges] { return get_total_double_repeats(ranges); });
+	bench.run_allocation_free(
+		"part_1/reference", [&ranges] { return get_total_double_repeats_reference(ranges); });
+	bench.run("part_2", [&ranges] { return get_total_periodic_repeats(ranges); });
+	bench.run_allocation_free(
+		"part_2/sequential", [&ranges] { return sum_periodic_ranges(ranges, 0, ranges.size()); });
+	bench.run("part_2/reference", [&ranges] { return get_total_periodic_repeats_reference(ranges); });
+}
+
+void verify(Verifier& verifier, const vector<string_view>& input_lines) {
+	vector<Range> ranges;
+	parse_input(ranges, input_lines[0]);
+	verifier.check(
+		"part_1",
+		[&ranges] { return get_total_double_repeats_reference(ranges); },
+		[&ranges] { return get_total_double_repeats(ranges); });
+	verifier.check(
+		"part_2",
+		[&ranges] { return get_total_periodic_repeats_reference(ranges); },
+		[&ranges] { return get_total_periodic_repeats(ranges); });
+}
+
+const RegisterSolver registered{
+	{2025, 2, "Gift Shop", solve, benchmark, generate_input, nullptr, nullptr, nullptr, verify}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
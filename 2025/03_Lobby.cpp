@@ -1,10 +1,19 @@
+#include "../common/bench.h"
+#include "../common/generate.h"
+#include "../common/line_stream.h"
+#include "../common/parallel.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <functional>
 #include <iostream>
 #include <numeric>
+#include <random>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace std;
@@ -30,7 +39,7 @@ void max_from(
 	size_t& index_result,
 	const size_t start_index_inclusive,
 	const size_t end_index_exclusive,
-	const string& string_of_integers) {
+	const string_view string_of_integers) {
 	index_result = start_index_inclusive;
 	for (size_t i = start_index_inclusive + 1; i < end_index_exclusive; ++i) {
 		if ((string_of_integers[i] - '0') > (string_of_integers[index_result] - '0')) {
@@ -39,7 +48,7 @@ void max_from(
 	}
 }
 
-u_ll get_max_joltage(const string& battery_bank, const size_t num_digits) {
+u_ll get_max_joltage(const string_view battery_bank, const size_t num_digits) {
 	const size_t n = battery_bank.size();
 
 	u_ll result = 0;
@@ -57,55 +66,84 @@ u_ll get_max_joltage(const string& battery_bank, const size_t num_digits) {
 	return result;
 }
 
-u_ll compute_total_max_joltage(const vector<string>& battery_banks, const size_t num_digits) {
+// the banks [begin, end), on the calling thread. Allocation-free
+u_ll sum_max_joltage(
+	const vector<string_view>& battery_banks,
+	const size_t begin,
+	const size_t end,
+	const size_t num_digits) {
 	u_ll result = 0;
-	const size_t n = battery_banks.size();
-	for (size_t i = 0; i < n; ++i) {
+	for (size_t i = begin; i < end; ++i) {
 		result += get_max_joltage(battery_banks[i], num_digits);
 	}
 	return result;
 }
 
+// every bank is independent, so chunks of banks are summed on all threads
+u_ll compute_total_max_joltage(const vector<string_view>& battery_banks, const size_t num_digits) {
+	return parallel_reduce(
+		battery_banks.size(),
+		256,
+		u_ll{0},
+		[&](const size_t begin, const size_t end) {
+			return sum_max_joltage(battery_banks, begin, end, num_digits);
+		},
+		plus<u_ll>{});
+}
+
 // Part 2
 // solved simply by increasing the digits to 12.
 
-void time_wrap(function<void(const vector<string>&)> func, const vector<string>& input) {
-	auto start = std::chrono::high_resolution_clock::now();
-	func(input);
-	auto end = std::chrono::high_resolution_clock::now();
-	std::chrono::duration<double> elapsed = end - start;
-	cout << "time_seconds=" << elapsed.count() << "\n";
-}
-
-int solve(vector<string>& input_lines) {
-	auto solve_1 = [](const vector<string>& battery_banks) {
-		u_ll result = compute_total_max_joltage(battery_banks, 2);
-		std::cout << "Part 1 : compute_total_max_joltage=" << result << "\n";
-	};
-	time_wrap(solve_1, input_lines);
+int solve(const vector<string_view>& input_lines, ostream& out) {
+	const u_ll result_1 = time_phase("part_1", [&] { return compute_total_max_joltage(input_lines, 2); });
+	out << "Part 1 : compute_total_max_joltage=" << result_1 << "\n";
 
-	auto solve_2 = [](const vector<string>& battery_banks) {
-		u_ll result = compute_total_max_joltage(battery_banks, 12);
-		std::cout << "Part 2 : compute_total_max_joltage=" << result << "\n";
-	};
-	time_wrap(solve_2, input_lines);
+	const u_ll result_2 = time_phase("part_2", [&] { return compute_total_max_joltage(input_lines, 12); });
+	out << "Part 2 : compute_total_max_joltage=" << result_2 << "\n";
 
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input_lines) {
-	string line;
-	while (getline(cin, line)) {
-		input_lines.push_back(line);
+// both parts in one pass over the banks, as they are read
+int solve_stream(LineStream& stream, ostream& out) {
+	ScopedPhase phase("stream");
+	u_ll result_1 = 0;
+	u_ll result_2 = 0;
+	vector<string_view> battery_banks;
+	while (stream.next(battery_banks)) {
+		result_1 += compute_total_max_joltage(battery_banks, 2);
+		result_2 += compute_total_max_joltage(battery_banks, 12);
 	}
+	out << "Part 1 : compute_total_max_joltage=" << result_1 << "\n";
+	out << "Part 2 : compute_total_max_joltage=" << result_2 << "\n";
+	return 0;
 }
 
-int main() {
-	vector<string> input_lines;
-	get_input_as_vector(input_lines);
-
-	if (0 != solve(input_lines)) {
-		return EXIT_FAILURE;
+// scale banks of 100 batteries rated 1..9
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	string bank(100, '0');
+	for (size_t i = 0; i < scale; ++i) {
+		for (char& battery : bank) {
+			battery = static_cast<char>('0' + random_between(rng, 1, 9));
+		}
+		os << bank << '\n';
 	}
-	return EXIT_SUCCESS;
 }
+
+// the parallel parts hand tasks to the pool, which allocates, so only the single threaded
+// sum is checked to be allocation-free
+void benchmark(Benchmark& bench, const vector<string_view>& input_lines) {
+	const size_t n = input_lines.size();
+	bench.run("part_1", [&input_lines] { return compute_total_max_joltage(input_lines, 2); });
+	bench.run_allocation_free(
+		"part_1/sequential", [&input_lines, n] { return sum_max_joltage(input_lines, 0, n, 2); });
+	bench.run("part_2", [&input_lines] { return compute_total_max_joltage(input_lines, 12); });
+	bench.run_allocation_free(
+		"part_2/sequential", [&input_lines, n] { return sum_max_joltage(input_lines, 0, n, 12); });
+}
+
+const RegisterSolver registered{{2025, 3, "Lobby", solve, benchmark, generate_input, solve_stream}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
@@ -1,11 +1,23 @@
+#include "../common/bench.h"
+#include "../common/binary_model.h"
+#include "../common/generate.h"
+#include "../common/parallel.h"
+#include "../common/parse_number.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+#include "../common/structural_index.h"
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <functional>
 #include <iostream>
 #include <numeric>
+#include <random>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -14,7 +26,13 @@ using namespace std;
 using u_ll = unsigned long long;
 using u_int = unsigned int;
 
-using Range = pair<u_ll, u_ll>;
+// like pair<u_ll, u_ll>, but trivially copyable, so that it maps straight from a binary model
+struct Range {
+	u_ll first;
+	u_ll second;
+};
+
+constexpr uint32_t MODEL_SCHEMA = 1; // of the binary model, bump when its records change
 
 constexpr char dash = '-';
 
@@ -40,25 +58,33 @@ constexpr char dash = '-';
 // this is the fastest!
 
 /**
- * @brief Convert the input to vectors.
+ * @brief Convert the input to vectors. The dash positions come from a single structural
+ *        index pass over the input rather than a find() per line.
  */
-void parse_input(vector<Range>& ranges, vector<u_ll>& ids, const vector<string>& input_lines) {
+void parse_input(vector<Range>& ranges, vector<u_ll>& ids, const vector<string_view>& input_lines) {
 	const size_t n = input_lines.size();
 	ranges.reserve(n);
 	ids.reserve(n);
 
+	StructuralIndex index;
+	build_structural_index(index, input_lines, string_view{&dash, 1});
+
 	bool at_ids = false;
-	for (const auto& line : input_lines) {
+	for (size_t i = 0; i < n; ++i) {
+		const string_view line = input_lines[i];
 		if (0 == line.size()) {
 			at_ids = true;
 			continue;
 		}
 
 		if (at_ids) {
-			ids.emplace_back(stoull(line));
+			ids.emplace_back(parse_uint<u_ll>(line));
 		} else {
-			size_t dash_pos = line.find(dash);
-			ranges.emplace_back(Range{stoull(line.substr(0, dash_pos)), stoull(line.substr(dash_pos + 1))});
+			const size_t dash_pos = index.delimiters_in_line(i)[0];
+			ranges.emplace_back(
+				Range{
+					parse_uint<u_ll>(line.substr(0, dash_pos)),
+					parse_uint<u_ll>(line.substr(dash_pos + 1))});
 		}
 	}
 }
@@ -93,12 +119,34 @@ void merge_ranges(vector<Range>& ranges) {
 	ranges.resize(i_curr_range + 1);
 }
 
-u_int count_fresh(vector<Range>& ranges, vector<u_ll>& ids) {
-	u_int result = 0;
+// what both parts read: the arrays of an Inventory, or of a mapped binary model
+struct InventoryView {
+	span<const Range> fresh_ranges; // sorted by start, disjoint
+	span<const u_ll> ids;			// sorted
+};
+
+/**
+ * @brief The parsed input, with the ranges merged and the ids sorted once. Both parts only read it,
+ *        so they can run at the same time.
+ */
+struct Inventory {
+	vector<Range> fresh_ranges;
+	vector<u_ll> ids;
+
+	InventoryView view() const { return {fresh_ranges, ids}; }
+};
+
+void parse_inventory(Inventory& inventory, const vector<string_view>& input_lines) {
+	parse_input(inventory.fresh_ranges, inventory.ids, input_lines);
+	merge_ranges(inventory.fresh_ranges);
+	sort(inventory.ids.begin(), inventory.ids.end());
+}
 
-	merge_ranges(ranges);
-	sort(ids.begin(), ids.end());
+u_int count_fresh(const InventoryView& inventory) {
+	u_int result = 0;
 
+	const span<const Range> ranges = inventory.fresh_ranges;
+	const span<const u_ll> ids = inventory.ids;
 	const size_t n_ranges = ranges.size();
 	const size_t n_ids = ids.size();
 
@@ -124,64 +172,85 @@ u_int count_fresh(vector<Range>& ranges, vector<u_ll>& ids) {
 	return result;
 }
 
-// Part 2 seems even easier. We just can merge and count a the valid ids at the same time
-u_ll count_total_possible_fresh(vector<Range>& ranges) {
+// Part 2 seems even easier. Once merged, we just count the valid ids of every range
+u_ll count_total_possible_fresh(const InventoryView& inventory) {
 	u_ll result = 0;
-	merge_ranges(ranges);
-	for (const Range& range : ranges) {
+	for (const Range& range : inventory.fresh_ranges) {
 		result += (range.second - range.first + 1);
 	}
 	return result;
 }
 
-void time_wrap(
-	std::function<void(vector<Range>&, vector<u_ll>&)> func,
-	vector<Range>& ranges,
-	vector<u_ll>& ids) {
-	auto start = std::chrono::high_resolution_clock::now();
-	func(ranges, ids);
-	auto end = std::chrono::high_resolution_clock::now();
-	std::chrono::duration<double> elapsed = end - start;
-	cout << "time_seconds=" << elapsed.count() << "\n";
+void solve_parts(const InventoryView& inventory, ostream& out) {
+	u_int num_fresh = 0;
+	u_ll total_fresh = 0;
+	run_concurrently(
+		[&] { num_fresh = time_phase("part_1", [&] { return count_fresh(inventory); }); },
+		[&] { total_fresh = time_phase("part_2", [&] { return count_total_possible_fresh(inventory); }); });
+
+	out << "Part 1 : num_fresh=" << num_fresh << "\n";
+	out << "Part 2 : count_total_possible_fresh=" << total_fresh << "\n";
 }
 
-int solve(const vector<string>& input_lines) {
-	// PART 1
-	auto part_1 = [](vector<Range>& ranges, vector<u_ll>& ids) {
-		u_int num_fresh = count_fresh(ranges, ids);
-		cout << "Part 1 : num_fresh=" << num_fresh << "\n";
-	};
-	vector<Range> ranges;
-	vector<u_ll> ids;
-	parse_input(ranges, ids, input_lines);
-	time_wrap(part_1, ranges, ids);
-
-	// PART 2
-	auto part_2 = [](vector<Range>& ranges, vector<u_ll>& ids) {
-		u_ll total_possible_fresh = count_total_possible_fresh(ranges);
-		cout << "Part 2 : count_total_possible_fresh=" << total_possible_fresh << "\n";
-	};
-	vector<Range> ranges2;
-	vector<u_ll> ids2;
-	parse_input(ranges2, ids2, input_lines);
-	time_wrap(part_2, ranges2, ids2);
+int solve(const vector<string_view>& input_lines, ostream& out) {
+	Inventory inventory;
+	time_phase("parse", [&] {
+		parse_inventory(inventory, input_lines);
+		return inventory.fresh_ranges.size();
+	});
+	solve_parts(inventory.view(), out);
+	return 0;
+}
 
+// the binary model holds the inventory already merged & sorted: the ranges, then the ids
+void write_model(const vector<string_view>& input_lines, ostream& os) {
+	Inventory inventory;
+	parse_inventory(inventory, input_lines);
+	BinaryModelWriter writer(2025, 5, MODEL_SCHEMA);
+	writer.add(inventory.fresh_ranges);
+	writer.add(inventory.ids);
+	writer.write(os);
+}
+
+int solve_model(const string& path, ostream& out) {
+	const BinaryModel model =
+		time_phase("load", [&path] { return BinaryModel::map(path, 2025, 5, MODEL_SCHEMA); });
+	solve_parts(InventoryView{model.section<Range>(0), model.section<u_ll>(1)}, out);
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input_lines) {
-	string line;
-	while (getline(cin, line)) {
-		input_lines.push_back(line);
+// scale ids to check, and scale / 5 (possibly overlapping) fresh ranges, over 15 digit ids
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	constexpr u_ll max_id = 999999999999999ULL;
+	const size_t n_ranges = max<size_t>(1, scale / 5);
+	for (size_t i = 0; i < n_ranges; ++i) {
+		const u_ll start = random_between(rng, 1, max_id);
+		const u_ll end = min(max_id, start + random_between(rng, 0, max_id / (4 * n_ranges)));
+		os << start << dash << end << '\n';
+	}
+	os << '\n';
+	for (size_t i = 0; i < scale; ++i) {
+		os << random_between(rng, 1, max_id) << '\n';
 	}
 }
 
-int main() {
-	vector<string> input_lines;
-	get_input_as_vector(input_lines);
+void benchmark(Benchmark& bench, const vector<string_view>& input_lines) {
+	bench.run("parse", [&input_lines] {
+		Inventory inventory;
+		parse_inventory(inventory, input_lines);
+		return inventory.fresh_ranges.size();
+	});
 
-	if (0 != solve(input_lines)) {
-		return EXIT_FAILURE;
-	}
-	return EXIT_SUCCESS;
+	Inventory inventory;
+	parse_inventory(inventory, input_lines);
+	const InventoryView view = inventory.view();
+	bench.run_allocation_free("part_1", [&view] { return count_fresh(view); });
+	bench.run_allocation_free("part_2", [&view] { return count_total_possible_fresh(view); });
 }
+
+const RegisterSolver registered{
+	{2025, 5, "Cafeteria", solve, benchmark, generate_input, nullptr, write_model, solve_model}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
@@ -1,10 +1,20 @@
+#include "../common/bench.h"
+#include "../common/generate.h"
+#include "../common/log.h"
+#include "../common/parallel.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <functional>
 #include <iostream>
 #include <numeric>
+#include <random>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace std;
@@ -29,7 +39,7 @@ ll do_operation(const ll l, const ll r, const char oper_char) {
 	} else if (MULTIPLY == oper_char) {
 		return l * r;
 	}
-	cerr << "Cannot perform op=" << oper_char << "\n";
+	log_line<LOG_ERROR>("Cannot perform op=", oper_char);
 	return l;
 }
 
@@ -42,16 +52,24 @@ ll solve_column(const size_t col, const char op, const vector<vector<ll>>& data_
 	return result;
 }
 
+// the columns are independent problems, summed in chunks on all threads
 ll compute_total_value(const vector<vector<ll>>& data_set, const vector<char>& operations) {
-	ll result = 0;
 	const size_t cols = data_set[0].size(); // protect later
-	for (size_t col = 0; col < cols; ++col) {
-		result += solve_column(col, operations[col], data_set);
-	}
-	return result;
+	return parallel_reduce(
+		cols,
+		1024,
+		ll{0},
+		[&](const size_t begin, const size_t end) {
+			ll result = 0;
+			for (size_t col = begin; col < end; ++col) {
+				result += solve_column(col, operations[col], data_set);
+			}
+			return result;
+		},
+		plus<ll>{});
 };
 
-void parse_method_1(vector<vector<ll>>& data_set, vector<char>& operations, const vector<string>& input) {
+void parse_method_1(vector<vector<ll>>& data_set, vector<char>& operations, const vector<string_view>& input) {
 	const size_t rows = input.size();
 	const size_t cols = input[0].size(); // protect later
 
@@ -99,7 +117,7 @@ void parse_method_1(vector<vector<ll>>& data_set, vector<char>& operations, cons
 	}
 }
 
-ll solve_part_1(const vector<string>& input) {
+ll solve_part_1(const vector<string_view>& input) {
 	vector<vector<ll>> data_set;
 	vector<char> operations;
 	parse_method_1(data_set, operations, input);
@@ -123,7 +141,7 @@ ll apply_operation(const vector<ll>& values, const char oper_char) {
 	return result;
 }
 
-ll compute_method_2(const vector<string>& input) {
+ll compute_method_2(const vector<string_view>& input) {
 	const size_t rows = input.size();
 	const size_t cols = input[0].size(); // assume all rows same length
 
@@ -169,42 +187,57 @@ ll compute_method_2(const vector<string>& input) {
 	return result;
 }
 
-void time_wrap(function<void(const vector<string>&)> func, const vector<string>& input1) {
-	auto start = chrono::system_clock::now();
-	func(input1);
-	auto end = chrono::system_clock::now();
-	chrono::duration<double> elapsed = end - start;
-	cout << "time_seconds=" << elapsed.count() << endl;
-}
+int solve(const vector<string_view>& input, ostream& out) {
+	const ll result_1 = time_phase("part_1", [&input] { return solve_part_1(input); });
+	out << "Part 1 : compute_total_value=" << result_1 << "\n";
 
-int solve(const vector<string>& input) {
-	auto solve1 = [](const vector<string>& i) {
-		ll result = solve_part_1(i);
-		cout << "Part 1 : compute_total_value=" << result << "\n";
-	};
-	time_wrap(solve1, input);
-
-	auto solve2 = [](const vector<string>& i) {
-		ll result = compute_method_2(i);
-		cout << "Part 2 : compute_total_value=" << result << "\n";
-	};
-	time_wrap(solve2, input);
+	const ll result_2 = time_phase("part_2", [&input] { return compute_method_2(input); });
+	out << "Part 2 : compute_total_value=" << result_2 << "\n";
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input) {
-	string line;
-	while (getline(cin, line)) {
-		input.push_back(line);
+// scale problems of 4 numbers with 1 to 4 digits. Each problem is as wide as its widest number,
+// numbers are randomly left or right aligned within it, and problems are split by a space column
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	constexpr size_t n_rows = 4;
+	vector<string> rows(n_rows + 1);
+	for (size_t problem = 0; problem < scale; ++problem) {
+		array<string, n_rows> numbers;
+		size_t width = 0;
+		for (string& number : numbers) {
+			const size_t digits = random_between(rng, 1, 4);
+			const ll lo = pow(10, digits - 1);
+			number = to_string(random_between(rng, lo, lo * 10 - 1));
+			width = max(width, number.size());
+		}
+		const bool align_left = random_chance(rng, 0.5);
+		for (size_t row = 0; row < n_rows; ++row) {
+			const string padding(width - numbers[row].size(), SPACE);
+			rows[row] += problem ? " " : "";
+			rows[row] += align_left ? numbers[row] + padding : padding + numbers[row];
+		}
+		rows[n_rows] += problem ? " " : "";
+		rows[n_rows] += random_chance(rng, 0.5) ? ADD : MULTIPLY;
+		rows[n_rows] += string(width - 1, SPACE);
+	}
+	for (const string& row : rows) {
+		os << row << '\n';
 	}
 }
 
-int main() {
-	vector<string> input;
-	get_input_as_vector(input);
-
-	if (0 != solve(input)) {
-		return EXIT_FAILURE;
-	}
-	return EXIT_SUCCESS;
+void benchmark(Benchmark& bench, const vector<string_view>& input) {
+	bench.run("parse", [&input] {
+		vector<vector<ll>> data_set;
+		vector<char> operations;
+		parse_method_1(data_set, operations, input);
+		return operations.size();
+	});
+	bench.run("part_1", [&input] { return solve_part_1(input); });
+	bench.run("part_2", [&input] { return compute_method_2(input); });
 }
+
+const RegisterSolver registered{{2025, 6, "Trash Compactor", solve, benchmark, generate_input}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
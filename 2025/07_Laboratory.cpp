@@ -1,10 +1,20 @@
+#include "../common/bench.h"
+#include "../common/generate.h"
+#include "../common/line_stream.h"
+#include "../common/log.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+
 #include <algorithm>
 #include <chrono>
+#include <climits>
 #include <cmath>
 #include <functional>
 #include <iostream>
 #include <numeric>
+#include <random>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace std;
@@ -44,28 +54,42 @@ constexpr char BEAM_SPLITTER = '^';
 // Space : O(cols)
 // This solution is best. Non-recursive & less space.
 
-void print_beam_state(const vector<u_int>& beam_state, const u_int max) {
+// debug dump, through log_dump<LOG_DEBUG>
+void print_beam_state(ostream& os, const vector<u_int>& beam_state, const u_int max) {
 	const size_t n = beam_state.size();
 	for (size_t i = 0; i < n; ++i) {
-		cout << (beam_state[i] < max ? '|' : '.');
+		os << (beam_state[i] < max ? '|' : '.');
 	}
-	cout << endl;
+	os << '\n';
 }
 
-u_ll number_splits(const vector<string>& manifold) {
-	const u_int rows = manifold.size();
-	const u_int cols = manifold[0].size();
+// The rows dont have to come all at once (--stream), so instead of the number of rows
+// "no beam" is marked by NO_BEAM, and the row index carries over between calls.
+constexpr u_int NO_BEAM = UINT_MAX;
 
+struct SplitState {
+	u_int row = 0;
+	vector<u_int> beam_state;
 	u_ll result = 0;
-	vector<u_int> beam_state(cols, rows); // beams are all "below bottom"
+};
 
-	for (u_int row = 0; row < rows; ++row) {
+void count_splits(SplitState& state, const vector<string_view>& manifold) {
+	if (manifold.empty())
+		return;
+	const u_int cols = manifold[0].size();
+	vector<u_int>& beam_state = state.beam_state;
+	if (beam_state.empty())
+		beam_state.assign(cols, NO_BEAM); // beams are all "below bottom"
+	u_ll& result = state.result;
+
+	for (const string_view line : manifold) {
+		const u_int row = state.row++;
 		for (u_int col = 0; col < cols; ++col) {
 			if (0 == row) {
-				if (START == manifold[row][col])
+				if (START == line[col])
 					beam_state[col] = row; // beam going down this column from this row
 			} else {
-				if (BEAM_SPLITTER == manifold[row][col] && beam_state[col] < row) {
+				if (BEAM_SPLITTER == line[col] && beam_state[col] < row) {
 					// there is a splitter here & there is a beam from above
 					++result;
 
@@ -74,17 +98,23 @@ u_ll number_splits(const vector<string>& manifold) {
 					if (col < cols - 1)
 						beam_state[col + 1] = row; // beam going down the right
 
-					if ((0 == col || OPEN_SPACE == manifold[row][col - 1]) &&
-						(cols - 1 == col || OPEN_SPACE == manifold[row][col + 1])) {
+					if ((0 == col || OPEN_SPACE == line[col - 1]) &&
+						(cols - 1 == col || OPEN_SPACE == line[col + 1])) {
 						// for the next iteration, there will be no beam.
-						beam_state[col] = rows;
+						beam_state[col] = NO_BEAM;
 					}
 				}
 			}
 		}
+		// the beams leaving this row
+		log_dump<LOG_DEBUG>([&beam_state, row](ostream& os) { print_beam_state(os, beam_state, row + 1); });
 	}
+}
 
-	return result;
+u_ll number_splits(const vector<string_view>& manifold) {
+	SplitState state;
+	count_splits(state, manifold);
+	return state.result;
 }
 
 // Part 2 : get number of paths
@@ -101,24 +131,35 @@ u_ll number_splits(const vector<string>& manifold) {
 // . . . ^ . ^ . .
 // . . | . | . .
 
-u_ll number_paths(const vector<string>& manifold) {
-	const u_int rows = manifold.size();
-	const u_int cols = manifold[0].size();
+struct PathState {
+	u_int row = 0;
+	vector<u_int> last_row_index_beam; // keep track of the beams above
+	vector<u_ll> paths_to_end_positions;
+};
 
-	vector<u_int> last_row_index_beam(cols, rows); // keep track of the beams above
-	vector<u_ll> paths_to_end_positions(cols, 0);  // there are 0 paths to begin with
+void count_paths(PathState& state, const vector<string_view>& manifold) {
+	if (manifold.empty())
+		return;
+	const u_int cols = manifold[0].size();
+	vector<u_int>& last_row_index_beam = state.last_row_index_beam;
+	vector<u_ll>& paths_to_end_positions = state.paths_to_end_positions;
+	if (last_row_index_beam.empty()) {
+		last_row_index_beam.assign(cols, NO_BEAM);
+		paths_to_end_positions.assign(cols, 0); // there are 0 paths to begin with
+	}
 
-	for (u_int row = 0; row < rows; ++row) {
+	for (const string_view line : manifold) {
+		const u_int row = state.row++;
 		for (u_int col = 0; col < cols; ++col) {
 			if (0 == row) {
-				if (START == manifold[row][col]) {
+				if (START == line[col]) {
 					// beam going down this column from this row.
 					// this is currently the only path
 					paths_to_end_positions[col] = 1;
 					last_row_index_beam[col] = row;
 				}
 			} else {
-				if (BEAM_SPLITTER == manifold[row][col] && last_row_index_beam[col] < row) {
+				if (BEAM_SPLITTER == line[col] && last_row_index_beam[col] < row) {
 					// there is a splitter here & there is a beam from above
 					if (col > 0) {
 						// beam splits to the left. Update the last beam row index for the left col
@@ -136,45 +177,84 @@ u_ll number_paths(const vector<string>& manifold) {
 							paths_to_end_positions[col + 1] + paths_to_end_positions[col];
 					}
 
-					if ((0 == col || OPEN_SPACE == manifold[row][col - 1]) &&
-						(cols - 1 == col || OPEN_SPACE == manifold[row][col + 1])) {
+					if ((0 == col || OPEN_SPACE == line[col - 1]) &&
+						(cols - 1 == col || OPEN_SPACE == line[col + 1])) {
 						// for the next iteration, there will be no beam.
 						// reset the last row index & remove the number of paths to this position
-						last_row_index_beam[col] = rows;
+						last_row_index_beam[col] = NO_BEAM;
 						paths_to_end_positions[col] = 0;
 					}
 				}
 			}
 		}
 	}
+}
+
+u_ll number_paths(const vector<string_view>& manifold) {
+	PathState state;
+	count_paths(state, manifold);
+	const vector<u_ll>& paths_to_end_positions = state.paths_to_end_positions;
 
 	// so now, our paths_to_end_positions contains the final locations of the beams
 	// and the number of ways to get to each location. sum and return.
 	return accumulate(paths_to_end_positions.begin(), paths_to_end_positions.end(), 0ULL);
 }
 
-int solve(const vector<string>& input_lines) {
-	u_ll result_1 = number_splits(input_lines);
-	cout << "Part 1 : number_splits=" << result_1 << endl;
+int solve(const vector<string_view>& input_lines, ostream& out) {
+	u_ll result_1 = time_phase("part_1", [&input_lines] { return number_splits(input_lines); });
+	out << "Part 1 : number_splits=" << result_1 << endl;
 
-	u_ll result_2 = number_paths(input_lines);
-	cout << "Part 2 : number_splits=" << result_2 << endl;
+	u_ll result_2 = time_phase("part_2", [&input_lines] { return number_paths(input_lines); });
+	out << "Part 2 : number_paths=" << result_2 << endl;
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input) {
-	string line;
-	while (getline(cin, line)) {
-		input.push_back(line);
+// both parts in one pass over the rows, as they are read
+int solve_stream(LineStream& stream, ostream& out) {
+	ScopedPhase phase("stream");
+	SplitState splits;
+	PathState paths;
+	vector<string_view> rows;
+	while (stream.next(rows)) {
+		count_splits(splits, rows);
+		count_paths(paths, rows);
 	}
+	const vector<u_ll>& ends = paths.paths_to_end_positions;
+	out << "Part 1 : number_splits=" << splits.result << endl;
+	out << "Part 2 : number_paths=" << accumulate(ends.begin(), ends.end(), 0ULL) << endl;
+	return 0;
 }
 
-int main() {
-	vector<string> input;
-	get_input_as_vector(input);
-
-	if (0 != solve(input)) {
-		return EXIT_FAILURE;
+// a manifold scale rows deep. The start is centered on the first row, and splitters sit on
+// every other row in the widening triangle the beams can reach, 2 columns apart, ~85% present
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	const size_t cols = scale | 1; // odd, so there is a center column
+	const size_t center = cols / 2;
+	string row(cols, OPEN_SPACE);
+	for (size_t r = 0; r < scale; ++r) {
+		fill(row.begin(), row.end(), OPEN_SPACE);
+		if (0 == r) {
+			row[center] = START;
+		} else if (0 == r % 2) {
+			const size_t depth = r / 2;
+			for (size_t offset = 0; offset < depth; ++offset) {
+				const size_t col = center - (depth - 1) + 2 * offset;
+				if (col < cols && random_chance(rng, 0.85)) {
+					row[col] = BEAM_SPLITTER;
+				}
+			}
+		}
+		os << row << '\n';
 	}
-	return EXIT_SUCCESS;
 }
+
+void benchmark(Benchmark& bench, const vector<string_view>& input_lines) {
+	bench.run("part_1", [&input_lines] { return number_splits(input_lines); });
+	bench.run("part_2", [&input_lines] { return number_paths(input_lines); });
+}
+
+const RegisterSolver registered{{2025, 7, "Laboratory", solve, benchmark, generate_input, solve_stream}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
@@ -1,3 +1,13 @@
+#include "../common/bench.h"
+#include "../common/binary_model.h"
+#include "../common/generate.h"
+#include "../common/log.h"
+#include "../common/parallel.h"
+#include "../common/parse_number.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+#include "../common/structural_index.h"
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
@@ -6,8 +16,11 @@
 #include <list>
 #include <numeric>
 #include <queue>
+#include <random>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -18,6 +31,7 @@ using u_ll = unsigned long long;
 using u_int = unsigned int;
 
 constexpr char COMMA = ',';
+constexpr uint32_t MODEL_SCHEMA = 1; // of the binary model, bump when its records change
 
 // Part 1
 // The naive solution is to do an n^2 traversal of the data,
@@ -101,37 +115,43 @@ double distance_between(const Coord& a, const Coord& b) {
 	return sqrt(square_diff(a, b));
 }
 
-void parse_coords(Coord& result, const string& input) {
+void parse_coords(Coord& result, const string_view input, const span<const uint32_t> commas) {
 	// Expect format: "x,y,z" with optional spaces
 	// dont worry about protecting
-	size_t p1 = input.find(COMMA);
-	size_t p2 = input.find(COMMA, p1 + 1);
-	result.x = stod(input.substr(0, p1));
-	result.y = stod(input.substr(p1 + 1, p2 - (p1 + 1)));
-	result.z = stod(input.substr(p2 + 1));
+	const size_t p1 = commas[0];
+	const size_t p2 = commas[1];
+	result.x = parse_double(input.substr(0, p1));
+	result.y = parse_double(input.substr(p1 + 1, p2 - (p1 + 1)));
+	result.z = parse_double(input.substr(p2 + 1));
 }
 
-void parse_input_to_coords(vector<Coord>& result, const vector<string>& input) {
+void parse_input_to_coords(vector<Coord>& result, const vector<string_view>& input) {
+	StructuralIndex index;
+	build_structural_index(index, input, string_view{&COMMA, 1});
+
 	const u_int n = input.size();
 	for (u_int i = 0; i < n; ++i) {
-		parse_coords(result[i], input[i]);
+		parse_coords(result[i], input[i], index.delimiters_in_line(i));
 	}
 }
 
 // make a bounded max heap
 // thus, you get the smallest num_pairs elements
-void order_closest_pairs(JBoxPairMaxHeap& result, const vector<Coord>& coords, u_int num_pairs) {
+void order_closest_pairs(JBoxPairMaxHeap& result, const span<const Coord> coords, u_int num_pairs) {
 	const u_int n = coords.size();
+	uint64_t heap_pushes = 0; // counted locally, reported once
 	for (u_int i = 0; i < n; ++i) {
 		// you should only loop through the j = i + 1 pairs because there will have already
 		// been a comparison between j = 0 to i and i.
 		for (u_int j = i + 1; j < n; ++j) {
 			result.push(JboxPair{i, j, distance_between(coords[i], coords[j])});
+			++heap_pushes;
 			if (result.size() > num_pairs) {
 				result.pop();
 			}
 		}
 	}
+	add_counter("heap_pushes", heap_pushes);
 }
 
 void merge_circuits(Circuits::iterator it1, Circuits::iterator it2, Circuits& circuits) {
@@ -187,11 +207,7 @@ void make_circuits(list<Circuit>& result, JBoxPairMaxHeap& pq) {
 	}
 }
 
-u_ll construct_closest_circuits(const vector<string>& input, const u_int num_pairs) {
-	const u_int n = input.size();
-	vector<Coord> coords(n, Coord{});
-	parse_input_to_coords(coords, input);
-
+u_ll construct_closest_circuits(const span<const Coord> coords, const u_int num_pairs) {
 	JBoxPairMaxHeap pq;
 	order_closest_pairs(pq, coords, num_pairs);
 
@@ -219,10 +235,8 @@ u_ll construct_closest_circuits(const vector<string>& input, const u_int num_pai
 // now, we just need to continue adding the closest circuits until
 // list<Circuit> size is 1
 // but you also need to check that all jboxes are added.
-double last_pair_single_circuit(const vector<string>& input) {
-	const u_int n = input.size();
-	vector<Coord> coords(n, Coord{});
-	parse_input_to_coords(coords, input);
+double last_pair_single_circuit(const span<const Coord> coords) {
+	const u_int n = coords.size();
 
 	// add all pairs this time
 	JBoxPairMinHeap pq;
@@ -250,47 +264,70 @@ double last_pair_single_circuit(const vector<string>& input) {
 		}
 	}
 
-	cout << last_x1 << ", " << last_x2 << "\n";
+	log_line<LOG_DEBUG>("last pair x=", last_x1, ", ", last_x2);
 
 	return last_x1 * last_x2;
 }
 
-void time_wrap(function<void(const vector<string>&)> func, const vector<string>& input) {
-	auto start = chrono::system_clock::now();
-	func(input);
-	auto end = chrono::system_clock::now();
-	chrono::duration<double> elapsed = end - start;
-	cout << "time_seconds=" << elapsed.count() << endl;
+// both parts only read the coordinates, so they run at the same time
+void solve_parts(const span<const Coord> coords, ostream& out) {
+	u_ll result_1 = 0;
+	double result_2 = 0.0;
+	run_concurrently(
+		[&] { result_1 = time_phase("part_1", [&] { return construct_closest_circuits(coords, 1000); }); },
+		[&] { result_2 = time_phase("part_2", [&] { return last_pair_single_circuit(coords); }); });
+
+	out << "Part 1 : result=" << result_1 << "\n";
+	out << "Part 2 : last_pair_single_circuit=" << result_2 << "\n";
 }
 
-int solve(const vector<string>& input_lines) {
-	auto solve_1 = [](const vector<string>& input) {
-		u_ll result = construct_closest_circuits(input, 1000);
-		cout << "Part 1 : result=" << result << "\n";
-	};
-	time_wrap(solve_1, input_lines);
-
-	auto solve_2 = [](const vector<string>& input) {
-		double result = last_pair_single_circuit(input);
-		cout << "Part 2 : last_pair_single_circuit=" << result << "\n";
-	};
-	time_wrap(solve_2, input_lines);
+int solve(const vector<string_view>& input_lines, ostream& out) {
+	vector<Coord> coords(input_lines.size(), Coord{});
+	time_phase("parse", [&] {
+		parse_input_to_coords(coords, input_lines);
+		return coords.size();
+	});
+	solve_parts(coords, out);
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input) {
-	string line;
-	while (getline(cin, line)) {
-		input.push_back(line);
-	}
+// the binary model is the flat array of coordinates
+void write_model(const vector<string_view>& input_lines, ostream& os) {
+	vector<Coord> coords(input_lines.size(), Coord{});
+	parse_input_to_coords(coords, input_lines);
+	BinaryModelWriter writer(2025, 8, MODEL_SCHEMA);
+	writer.add(coords);
+	writer.write(os);
 }
 
-int main() {
-	vector<string> input;
-	get_input_as_vector(input);
+int solve_model(const string& path, ostream& out) {
+	const BinaryModel model =
+		time_phase("load", [&path] { return BinaryModel::map(path, 2025, 8, MODEL_SCHEMA); });
+	solve_parts(model.section<Coord>(0), out);
+	return 0;
+}
 
-	if (0 != solve(input)) {
-		return EXIT_FAILURE;
+// scale junction boxes with coordinates in [0, 99999]
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	for (size_t i = 0; i < scale; ++i) {
+		os << random_between(rng, 0, 99999) << COMMA << random_between(rng, 0, 99999) << COMMA
+		   << random_between(rng, 0, 99999) << '\n';
 	}
-	return EXIT_SUCCESS;
 }
+
+void benchmark(Benchmark& bench, const vector<string_view>& input_lines) {
+	vector<Coord> coords(input_lines.size(), Coord{});
+	bench.run("parse", [&] {
+		parse_input_to_coords(coords, input_lines);
+		return coords.size();
+	});
+	bench.run("part_1", [&coords] { return construct_closest_circuits(coords, 1000); });
+	bench.run("part_2", [&coords] { return last_pair_single_circuit(coords); });
+}
+
+const RegisterSolver registered{
+	{2025, 8, "Playground", solve, benchmark, generate_input, nullptr, write_model, solve_model}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
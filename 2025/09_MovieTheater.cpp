@@ -1,15 +1,29 @@
+#include "../common/bench.h"
+#include "../common/binary_model.h"
+#include "../common/generate.h"
+#include "../common/log.h"
+#include "../common/parallel.h"
+#include "../common/parse_number.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+#include "../common/verify.h"
+
 #include <algorithm>
 #include <chrono>
+#include <climits>
 #include <cmath>
 #include <functional>
 #include <iostream>
 #include <numeric>
 #include <queue>
+#include <random>
 #include <set>
+#include <span>
 #include <sstream>
 #include <stack>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -23,6 +37,7 @@ struct Coords {
 };
 
 constexpr char COMMA = ',';
+constexpr uint32_t MODEL_SCHEMA = 1; // of the binary model, bump when its records change
 
 // Part 1
 // The most simple approach is to do an iteration of all pairs
@@ -33,27 +48,6 @@ ll area(const Coords& a, const Coords& b) {
 	return (max_x - min_x + 1) * (max_y - min_y + 1);
 }
 
-void parse_input(vector<Coords>& result, const vector<string>& input) {
-	for (const string& line : input) {
-		const size_t pos_comma = line.find(COMMA);
-		result.emplace_back(Coords{stoll(line.substr(0, pos_comma)), stoll(line.substr(pos_comma + 1))});
-	}
-}
-
-ll max_rectangle_quadratic(const vector<string>& input) {
-	vector<Coords> coords;
-	parse_input(coords, input);
-
-	const size_t n = coords.size();
-	ll max_size = 0;
-	for (size_t i = 0; i < n; ++i) {
-		for (size_t j = i + 1; j < n; ++j) {
-			max_size = max(max_size, area(coords[i], coords[j]));
-		}
-	}
-	return max_size;
-}
-
 /*
  * Part 2
  * This is a big problem, and there may be many iterations to make more efficient
@@ -109,6 +103,66 @@ struct Corner {
 	ll max_size;
 };
 
+// Part 1, on the parsed corners
+ll max_rectangle_quadratic(const span<const Corner> corners) {
+	const size_t n = corners.size();
+	ll max_size = 0;
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = i + 1; j < n; ++j) {
+			max_size = max(max_size, area(corners[i].original_coords, corners[j].original_coords));
+		}
+	}
+	return max_size;
+}
+
+// The corners that no other corner beats in both directions, a staircase: with x ascending (x_sign 1)
+// or descending (-1), the ones whose y is below (y_sign 1) or above (-1) every y before them.
+vector<Coords> staircase(const span<const Corner> corners, const ll x_sign, const ll y_sign) {
+	vector<Coords> points;
+	points.reserve(corners.size());
+	for (const Corner& corner : corners) {
+		points.push_back(Coords{corner.original_coords.x * x_sign, corner.original_coords.y * y_sign});
+	}
+	sort(points.begin(), points.end(), [](const Coords& a, const Coords& b) {
+		return a.x != b.x ? a.x < b.x : a.y < b.y;
+	});
+
+	vector<Coords> result;
+	ll lowest_y = LLONG_MAX;
+	for (const Coords& point : points) {
+		if (point.y < lowest_y) {
+			lowest_y = point.y;
+			result.push_back(Coords{point.x * x_sign, point.y * y_sign});
+		}
+	}
+	return result;
+}
+
+/**
+ * @brief Part 1 without trying every pair. The best rectangle has one corner at its bottom left and
+ *        one at its top right (or top left and bottom right). Moving the bottom left corner further
+ *        down or left only grows the rectangle, so it is on the bottom left staircase, and the top right
+ *        one on the top right staircase. Only pairs across two staircases are tried, which for most
+ *        inputs are far fewer corners than n. max_rectangle_quadratic stays as its reference (`--verify`).
+ *
+ *        Time : O(n log n + h^2), h the size of the staircases
+ */
+ll max_rectangle_staircase(const span<const Corner> corners) {
+	if (corners.size() < 2)
+		return 0;
+	ll max_size = 0;
+	const auto max_across = [&max_size](const vector<Coords>& a, const vector<Coords>& b) {
+		for (const Coords& first : a) {
+			for (const Coords& second : b) {
+				max_size = max(max_size, area(first, second));
+			}
+		}
+	};
+	max_across(staircase(corners, 1, 1), staircase(corners, -1, -1));
+	max_across(staircase(corners, 1, -1), staircase(corners, -1, 1));
+	return max_size;
+}
+
 std::ostream& operator<<(std::ostream& os, const Corner& corner) {
 	os << "original=[x=" << corner.original_coords.x << ", y=" << corner.original_coords.y
 	   << "] -> mapped=[x=" << corner.mapped_coords.x << ", y=" << corner.mapped_coords.y << "]"
@@ -129,29 +183,22 @@ struct GridItem {
 };
 using Grid = vector<vector<GridItem>>;
 
-void print_grid(const Grid& grid, const bool heights = false) {
+// debug dump, through log_dump<LOG_DEBUG>
+void print_grid(ostream& os, const Grid& grid, const bool heights = false) {
 	const size_t rows = grid.size();
 	const size_t cols = grid[0].size();
 
-	if (!heights) {
-		stringstream ss;
-		for (size_t row = 0; row < rows; ++row) {
-			for (size_t col = 0; col < cols; ++col) {
-				ss << " " << grid[row][col].symbol << " ";
+	for (size_t row = 0; row < rows; ++row) {
+		for (size_t col = 0; col < cols; ++col) {
+			if (heights) {
+				os << " " << grid[row][col].relative_height << " ";
+			} else {
+				os << " " << grid[row][col].symbol << " ";
 			}
-			ss << "\n";
 		}
-		cout << ss.str() << endl;
-	} else {
-		stringstream ss;
-		for (size_t row = 0; row < rows; ++row) {
-			for (size_t col = 0; col < cols; ++col) {
-				ss << " " << grid[row][col].relative_height << " ";
-			}
-			ss << "\n";
-		}
-		cout << ss.str() << endl;
+		os << "\n";
 	}
+	os << "\n";
 }
 
 /**
@@ -214,10 +261,14 @@ void make_heights_dp(Grid& grid) {
 ll get_max_rectangle(Grid& grid, vector<Corner>& corners) {
 	// pre-populate the relative heights so the
 	// max_rectangle_for_corners only has to traverse in 1 dimension
-	make_heights_dp(grid);
+	{
+		ScopedPhase phase("heights");
+		make_heights_dp(grid);
+	}
 
-	print_grid(grid, true);
+	log_dump<LOG_DEBUG>([&grid](ostream& os) { print_grid(os, grid, true); });
 
+	ScopedPhase phase("pair_scan");
 	ll result = 0LL;
 	const size_t n = corners.size();
 	for (size_t i = 0; i < n; ++i) {
@@ -225,6 +276,7 @@ ll get_max_rectangle(Grid& grid, vector<Corner>& corners) {
 			result = max(result, max_rectangle_for_corners(corners[j], corners[i], grid));
 		}
 	}
+	add_counter("pairs", n * (n - 1) / 2);
 	return result;
 }
 
@@ -454,7 +506,7 @@ Grid create_compressed_grid(vector<Corner>& corners_in) {
 }
 
 // expects result to be initialized to correct size
-void parse_input_to_corners(vector<Corner>& result, const vector<string>& input) {
+void parse_input_to_corners(vector<Corner>& result, const vector<string_view>& input) {
 	const ll n = input.size();
 	if (result.size() != n) {
 		throw runtime_error("Invalid size");
@@ -463,67 +515,128 @@ void parse_input_to_corners(vector<Corner>& result, const vector<string>& input)
 		Corner& corner = result[i];
 		corner.original_index = i;
 
-		const string& line = input[i];
+		const string_view line = input[i];
 		const size_t pos_comma = line.find(COMMA);
-		corner.original_coords.x = stoull(line.substr(0, pos_comma));
-		corner.original_coords.y = stoull(line.substr(pos_comma + 1));
+		corner.original_coords.x = parse_int<ll>(line.substr(0, pos_comma));
+		corner.original_coords.y = parse_int<ll>(line.substr(pos_comma + 1));
 	}
 }
 
-ll max_rectangle_part_2(const vector<string>& input) {
-	const ll n = input.size();
-
-	// parse to corners, containing the original coordinates
-	Corner base;
-	vector<Corner> corners(n, Corner{});
-	parse_input_to_corners(corners, input);
+// works on its own copy of the corners, which it maps to the compressed grid
+ll max_rectangle_part_2(const span<const Corner> parsed_corners) {
+	vector<Corner> corners(parsed_corners.begin(), parsed_corners.end());
 
 	// Create a compressed, filled grid
-	Grid grid = create_compressed_grid(corners);
-	create_polygon_borders(grid, corners);
-	fill_grid(grid, corners);
+	Grid grid = time_phase("compress", [&corners] { return create_compressed_grid(corners); });
+	{
+		ScopedPhase phase("fill");
+		create_polygon_borders(grid, corners);
+		fill_grid(grid, corners);
+		add_counter("grid_cells", grid.size() * grid[0].size());
+	}
 
 	// solve using our compressed grid & corners
 	return get_max_rectangle(grid, corners);
 }
 
-void time_wrap(function<void(const vector<string>&)> func, const vector<string>& input) {
-	auto start = chrono::system_clock::now();
-	func(input);
-	auto end = chrono::system_clock::now();
-	chrono::duration<double> elapsed = end - start;
-	cout << "time_seconds=" << elapsed.count() << endl;
+// both parts only read the corners, so they run at the same time
+void solve_parts(const span<const Corner> corners, ostream& out) {
+	// part 1 used to be left out of the normal run for its cost, it now overlaps with part 2
+	ll result_1 = 0;
+	ll result_2 = 0;
+	run_concurrently(
+		[&] { result_2 = time_phase("part_2", [&] { return max_rectangle_part_2(corners); }); },
+		[&] { result_1 = time_phase("part_1", [&] { return max_rectangle_staircase(corners); }); });
+
+	out << "Part 1 : max_rectangle_staircase=" << result_1 << "\n";
+	out << "Part 2 : max_rectangle_part_2=" << result_2 << "\n";
 }
 
-int solve(vector<string>& input_lines) {
-	auto solve_1 = [](const vector<string>& input) {
-		ll result = max_rectangle_quadratic(input);
-		cout << "Part 1 : max_rectangle_quadratic=" << result << "\n";
-	};
-	// time_wrap(solve_1, input_lines);
+int solve(const vector<string_view>& input_lines, ostream& out) {
+	// parse to corners, containing the original coordinates
+	vector<Corner> corners(input_lines.size(), Corner{});
+	{
+		ScopedPhase phase("parse");
+		parse_input_to_corners(corners, input_lines);
+	}
+	solve_parts(corners, out);
+	return 0;
+}
 
-	auto solve_2 = [](const vector<string>& input) {
-		ll result = max_rectangle_part_2(input);
-		cout << "Part 2 : max_rectangle_part_2=" << result << "\n";
-	};
-	time_wrap(solve_2, input_lines);
+// the binary model is the flat array of parsed corners, in input order
+void write_model(const vector<string_view>& input_lines, ostream& os) {
+	vector<Corner> corners(input_lines.size(), Corner{});
+	parse_input_to_corners(corners, input_lines);
+	BinaryModelWriter writer(2025, 9, MODEL_SCHEMA);
+	writer.add(corners);
+	writer.write(os);
+}
 
+int solve_model(const string& path, ostream& out) {
+	const BinaryModel model =
+		time_phase("load", [&path] { return BinaryModel::map(path, 2025, 9, MODEL_SCHEMA); });
+	solve_parts(model.section<Corner>(0), out);
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input) {
-	string line;
-	while (getline(cin, line)) {
-		input.push_back(line);
+// A simple rectilinear polygon with ~scale corners, listed in order.
+// It is a run of k columns at increasing x: the top edge is a staircase going right and
+// the bottom edge a staircase coming back, so 4k corners. Every column spans the
+// middle height, so consecutive columns always overlap and the polygon never self-intersects.
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	const size_t k = max<size_t>(1, scale / 4);
+	const ll width = max<ll>(100000, 4 * k);
+	const ll height = 100000;
+
+	// k + 1 distinct, increasing x coordinates
+	set<ll> xs_set;
+	while (xs_set.size() < k + 1) {
+		xs_set.insert(random_between(rng, 1, width));
+	}
+	const vector<ll> xs(xs_set.begin(), xs_set.end());
+
+	// column heights. neighbours differ so that no corner is collinear with its neighbours
+	vector<ll> tops(k), bottoms(k);
+	for (size_t i = 0; i < k; ++i) {
+		do {
+			tops[i] = random_between(rng, height / 2 + 1, height);
+		} while (i > 0 && tops[i] == tops[i - 1]);
+		do {
+			bottoms[i] = random_between(rng, 1, height / 2 - 1);
+		} while (i > 0 && bottoms[i] == bottoms[i - 1]);
+	}
+
+	for (size_t i = 0; i < k; ++i) {
+		os << xs[i] << COMMA << tops[i] << '\n' << xs[i + 1] << COMMA << tops[i] << '\n';
+	}
+	for (size_t i = k; i-- > 0;) {
+		os << xs[i + 1] << COMMA << bottoms[i] << '\n' << xs[i] << COMMA << bottoms[i] << '\n';
 	}
 }
 
-int main() {
-	vector<string> input;
-	get_input_as_vector(input);
+void benchmark(Benchmark& bench, const vector<string_view>& input_lines) {
+	vector<Corner> corners(input_lines.size(), Corner{});
+	bench.run("parse", [&] {
+		parse_input_to_corners(corners, input_lines);
+		return corners.size();
+	});
+	bench.run("part_1", [&corners] { return max_rectangle_staircase(corners); });
+	bench.run("part_1/reference", [&corners] { return max_rectangle_quadratic(corners); });
+	bench.run("part_2", [&corners] { return max_rectangle_part_2(corners); });
+}
 
-	if (0 != solve(input)) {
-		return EXIT_FAILURE;
-	}
-	return EXIT_SUCCESS;
+void verify(Verifier& verifier, const vector<string_view>& input_lines) {
+	vector<Corner> corners(input_lines.size(), Corner{});
+	parse_input_to_corners(corners, input_lines);
+	verifier.check(
+		"part_1",
+		[&corners] { return max_rectangle_quadratic(corners); },
+		[&corners] { return max_rectangle_staircase(corners); });
 }
+
+const RegisterSolver registered{
+	{2025, 9, "Movie Theater", solve, benchmark, generate_input, nullptr, write_model, solve_model, verify}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
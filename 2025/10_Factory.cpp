@@ -1,3 +1,16 @@
+#include "../common/bench.h"
+#include "../common/binary_model.h"
+#include "../common/generate.h"
+#include "../common/line_stream.h"
+#include "../common/log.h"
+#include "../common/parallel.h"
+#include "../common/parse_number.h"
+#include "../common/phase.h"
+#include "../common/registry.h"
+#include "../common/result_cache.h"
+#include "../common/structural_index.h"
+#include "../common/verify.h"
+
 #include <algorithm>
 #include <bit>
 #include <chrono>
@@ -6,8 +19,13 @@
 #include <functional>
 #include <iostream>
 #include <numeric>
+#include <optional>
 #include <queue>
+#include <random>
+#include <span>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -17,10 +35,7 @@ using namespace std;
 
 using u_ll = unsigned long long;
 
-constexpr char BRACES_START = '{';
 constexpr char BRACES_END = '}';
-constexpr char BRACKET_CLOSE = ']';
-constexpr char COMMA = ',';
 constexpr char MACHINE_INDICATOR_ON = '#';
 constexpr char PARENS_CLOSE = ')';
 constexpr char PARENS_OPEN = '(';
@@ -45,6 +60,18 @@ struct Machine {
 	vector<int> joltage_requirements;
 };
 
+constexpr uint32_t MODEL_SCHEMA = 1; // of the binary model, bump when its records change
+
+// a Machine of the binary model: its buttons and joltages are slices of the two int sections
+struct PackedMachine {
+	int final_state;
+	int bit_size;
+	uint32_t first_button;
+	uint32_t n_buttons;
+	uint32_t first_joltage;
+	uint32_t n_joltages;
+};
+
 // state keeps track of the button index & the current toggle state
 struct BfsStateLights {
 	BfsStateLights(int c, size_t p) : curr_state{c}, pos{p} {}
@@ -66,22 +93,23 @@ string get_bit_str(int bits, int size) {
 	return ss.str();
 }
 
-void print_machine(const Machine& machine) {
-	cout << "Machine=[\n"
-		 << "\tfinal_schematic_state=" << get_bit_str(machine.final_state, machine.bit_size)
-		 << "\n\tbuttons=(";
+// debug dump, through log_dump<LOG_DEBUG>
+void print_machine(ostream& os, const Machine& machine) {
+	os << "Machine=[\n"
+	   << "\tfinal_schematic_state=" << get_bit_str(machine.final_state, machine.bit_size)
+	   << "\n\tbuttons=(";
 	const size_t n = machine.buttons.size();
 	for (size_t i = 0; i < n; ++i) {
-		cout << get_bit_str(machine.buttons[i], machine.bit_size);
-		cout << (i == n - 1 ? ")" : ",");
+		os << get_bit_str(machine.buttons[i], machine.bit_size);
+		os << (i == n - 1 ? ")" : ",");
 	}
-	cout << "\n\tjoltage_requirements=(";
+	os << "\n\tjoltage_requirements=(";
 	const size_t n_joltage = machine.joltage_requirements.size();
 	for (size_t i = 0; i < n_joltage; ++i) {
-		cout << machine.joltage_requirements[i];
-		cout << (i == n_joltage - 1 ? ")" : ",");
+		os << machine.joltage_requirements[i];
+		os << (i == n_joltage - 1 ? ")" : ",");
 	}
-	cout << "\n]\n";
+	os << "\n]\n";
 }
 
 int bfs_buttons_for_lights(const Machine& machine) {
@@ -121,7 +149,52 @@ int bfs_buttons_for_lights(const Machine& machine) {
 	return 0;
 }
 
+// The Gray code walk is 2^buttons XORs. The BFS visits up to 2^lights states and does a hashed insert
+// per button from each, some 2^5 XORs apiece, so the walk stays cheaper up to about lights + 5 buttons
+constexpr size_t GRAY_CODE_EXTRA_BUTTONS = 5;
+
+// Pressing a button twice undoes it, so an answer is a subset of the buttons, pressed once each.
+// The 2^n subsets are walked in Gray code order, where each one differs from the last by a single
+// button, so every step is one XOR and no state is stored.
+// bfs_buttons_for_lights stays as its reference (`--verify`)
+int gray_code_buttons_for_lights(const Machine& machine) {
+	const vector<int>& buttons = machine.buttons;
+	const size_t n = buttons.size();
+	if (n > static_cast<size_t>(machine.bit_size) + GRAY_CODE_EXTRA_BUTTONS) {
+		return bfs_buttons_for_lights(machine);
+	}
+
+	int best = 0 == machine.final_state ? 0 : INT_MAX;
+	int state = 0;
+	u_ll pressed = 0; // the buttons of the current subset
+	for (u_ll i = 1; i < (1ULL << n); ++i) {
+		const int flipped = countr_zero(i);
+		state ^= buttons[flipped];
+		pressed ^= 1ULL << flipped;
+		if (state == machine.final_state) {
+			best = min(best, popcount(pressed));
+		}
+	}
+	return INT_MAX == best ? 0 : best;
+}
+
+// the machines are independent, so chunks of them are solved on all threads
 int get_min_steps_for_lights(const vector<Machine>& machines) {
+	return parallel_reduce(
+		machines.size(),
+		16,
+		0,
+		[&machines](const size_t begin, const size_t end) {
+			int result = 0;
+			for (size_t i = begin; i < end; ++i) {
+				result += gray_code_buttons_for_lights(machines[i]);
+			}
+			return result;
+		},
+		plus<int>{});
+}
+
+int get_min_steps_for_lights_bfs(const vector<Machine>& machines) {
 	int result = 0;
 	for (const Machine& machine : machines) {
 		result += bfs_buttons_for_lights(machine);
@@ -129,7 +202,7 @@ int get_min_steps_for_lights(const vector<Machine>& machines) {
 	return result;
 }
 
-int get_schematic_as_bits(const string& input, const size_t start, const size_t end_exclusive) {
+int get_schematic_as_bits(const string_view input, const size_t start, const size_t end_exclusive) {
 	int bits = 0;
 	for (size_t j = start; j < end_exclusive; ++j) {
 		bits <<= 1;
@@ -140,61 +213,78 @@ int get_schematic_as_bits(const string& input, const size_t start, const size_t
 	return bits;
 }
 
-void parse_joltage(Machine& machine, const string& input) {
-	size_t i = input.find(BRACES_START) + 1;
-	size_t idx_end = input.find(BRACES_END, i);
-	while (i < idx_end) {
-		size_t pos_comma = input.find(COMMA, i);
-		size_t jolt_end_idx = pos_comma == string::npos ? idx_end : pos_comma;
-		machine.joltage_requirements.emplace_back(stoi(input.substr(i, jolt_end_idx)));
-		i = jolt_end_idx + 1;
+// every character that separates fields of a machine line. indexed once up front so the parsers
+// below only ever walk precomputed positions
+constexpr string_view MACHINE_DELIMITERS = "](),{}";
+
+// delimiters[k] is the '{'. Each following ',' or '}' ends a joltage value
+void parse_joltage(
+	Machine& machine,
+	const string_view input,
+	const span<const uint32_t> delimiters,
+	size_t k) {
+	size_t field_start = delimiters[k] + 1;
+	for (++k; k < delimiters.size(); ++k) {
+		const size_t end_pos = delimiters[k];
+		machine.joltage_requirements.emplace_back(
+			parse_int<int>(input.substr(field_start, end_pos - field_start)));
+		if (BRACES_END == input[end_pos]) {
+			break;
+		}
+		field_start = end_pos + 1;
 	}
 }
 
-void parse_buttons(Machine& machine, const string& input, const size_t start) {
-	size_t pos_end = input.find(BRACES_START, start);
-	size_t i = start;
-	while (i < pos_end) {
-		size_t pos_parens_open = input.find(PARENS_OPEN, i);
-		if (pos_parens_open == string::npos || pos_parens_open >= pos_end) {
-			break; // No more buttons to parse
-		}
-		size_t pos_parens_close = input.find(PARENS_CLOSE, pos_parens_open);
-
+// walks the buttons starting at delimiters[k], which is the first '('.
+// returns the index of the first delimiter after the buttons, ie the '{'
+size_t parse_buttons(
+	Machine& machine,
+	const string_view input,
+	const span<const uint32_t> delimiters,
+	size_t k) {
+	const size_t n = delimiters.size();
+	while (k < n && PARENS_OPEN == input[delimiters[k]]) {
 		int button_bits = 0;
-		size_t j = pos_parens_open + 1; // Start after '('
-		while (j < pos_parens_close) {
-			size_t pos_comma = input.find(COMMA, j);
-			size_t end_pos =
-				(pos_comma == string::npos || pos_comma > pos_parens_close) ? pos_parens_close : pos_comma;
+		size_t field_start = delimiters[k] + 1; // Start after '('
 
-			string num_str = input.substr(j, end_pos - j);
-			int indicator_position = stoi(num_str);
+		// each ',' or ')' ends an indicator position
+		for (++k; k < n; ++k) {
+			const size_t end_pos = delimiters[k];
+			int indicator_position = parse_int<int>(input.substr(field_start, end_pos - field_start));
 
 			// we need to read bits as right to left
 			int bit_idx = machine.bit_size - 1 - indicator_position;
 			button_bits |= (1 << bit_idx);
 
-			j = end_pos + 1; // Move past ',' or ')'
+			field_start = end_pos + 1; // Move past ',' or ')'
+			if (PARENS_CLOSE == input[end_pos]) {
+				break;
+			}
 		}
 
 		machine.buttons.push_back({button_bits}); // Store the binary representation
-		i = pos_parens_close + 1;				  // Move to the next button
+		++k;									  // Move to the next button
 	}
+	return k;
 }
 
-void parse_input(vector<Machine>& results, const vector<string>& input) {
+void parse_input(vector<Machine>& results, const vector<string_view>& input) {
+	StructuralIndex index;
+	build_structural_index(index, input, MACHINE_DELIMITERS);
+
 	const size_t n = input.size();
 	for (size_t i = 0; i < n; ++i) {
-		const string& raw_machine = input[i];
-		const size_t pos_bracket_close = raw_machine.find(BRACKET_CLOSE);
+		const string_view raw_machine = input[i];
+		const span<const uint32_t> delimiters = index.delimiters_in_line(i);
+		const size_t pos_bracket_close = delimiters[0]; // ']' is always the first delimiter
 
 		Machine& machine = results[i];
 		machine.final_state = get_schematic_as_bits(raw_machine, 1, pos_bracket_close);
 		machine.bit_size = pos_bracket_close - 1;
-		parse_buttons(results[i], raw_machine, pos_bracket_close + 1);
+		const size_t k_braces = parse_buttons(machine, raw_machine, delimiters, 1);
 
-		parse_joltage(machine, raw_machine);
+		parse_joltage(machine, raw_machine, delimiters, k_braces);
+		log_dump<LOG_DEBUG>([&machine](ostream& os) { print_machine(os, machine); });
 	}
 }
 
@@ -235,6 +325,7 @@ int bfs_for_joltage(const Machine& machine) {
 	visited.insert(vec_key(q.front().curr_joltage));
 
 	int steps = 0;
+	uint64_t states_expanded = 0; // counted locally, reported once
 	while (!q.empty()) {
 		const size_t q_size = q.size();
 
@@ -251,9 +342,11 @@ int bfs_for_joltage(const Machine& machine) {
 				}
 			}
 			if (all_match) {
+				add_counter("states_expanded", states_expanded);
 				return steps;
 			}
 
+			++states_expanded;
 			for (size_t bidx = 0; bidx < n_buttons; ++bidx) {
 				const int button_value = buttons[bidx];
 
@@ -286,57 +379,262 @@ int bfs_for_joltage(const Machine& machine) {
 		++steps; // Increment depth
 	}
 
+	add_counter("states_expanded", states_expanded);
 	return 0;
 }
 
-int get_min_presses_joltage(const vector<Machine>& machines) {
-	int result = 0;
-	for (const Machine& machine : machines) {
-		result += bfs_for_joltage(machine);
+// The part 2 presses of every machine seen so far, kept across runs and inputs with --cache.
+// The lights play no part in it, so only the buttons and the joltages make the key.
+ResultMemo& joltage_memo() {
+	static ResultMemo memo("2025_10_joltage");
+	return memo;
+}
+
+uint64_t joltage_key(const Machine& machine) {
+	string bytes;
+	bytes.reserve(sizeof(int) * (1 + machine.buttons.size() + machine.joltage_requirements.size()) + 1);
+	const auto append = [&bytes](const int value) {
+		bytes.append(reinterpret_cast<const char*>(&value), sizeof(int));
+	};
+	append(machine.bit_size);
+	for (const int button : machine.buttons) {
+		append(button);
+	}
+	bytes.push_back('{');
+	for (const int joltage : machine.joltage_requirements) {
+		append(joltage);
+	}
+	return joltage_memo().key(bytes);
+}
+
+// the presses and the memo hits of a chunk of machines
+struct JoltagePresses {
+	int presses = 0;
+	uint64_t memo_hits = 0;
+};
+
+JoltagePresses get_min_presses_joltage_between(
+	const vector<Machine>& machines,
+	const size_t begin,
+	const size_t end) {
+	ResultMemo& memo = joltage_memo();
+	JoltagePresses result;
+	for (size_t i = begin; i < end; ++i) {
+		ScopedTask task("machine", i);
+		if (!memo.enabled()) {
+			result.presses += bfs_for_joltage(machines[i]);
+			continue;
+		}
+
+		const uint64_t key = joltage_key(machines[i]);
+		if (const optional<int64_t> presses = memo.find(key)) {
+			result.presses += *presses;
+			++result.memo_hits;
+		} else {
+			const int computed = bfs_for_joltage(machines[i]);
+			memo.insert(key, computed);
+			result.presses += computed;
+		}
 	}
 	return result;
 }
 
-void time_wrap(function<void(const vector<Machine>&)> func, const vector<Machine>& input) {
-	auto start = chrono::system_clock::now();
-	func(input);
-	auto end = chrono::system_clock::now();
-	chrono::duration<double> elapsed = end - start;
-	cout << "time_seconds=" << elapsed.count() << endl;
+// one BFS per machine, the machines on all threads. They vary a lot in cost, so the chunks are
+// as small as they get
+int get_min_presses_joltage(const vector<Machine>& machines) {
+	const JoltagePresses total = parallel_reduce(
+		machines.size(),
+		1,
+		JoltagePresses{},
+		[&machines](const size_t begin, const size_t end) {
+			return get_min_presses_joltage_between(machines, begin, end);
+		},
+		[](const JoltagePresses& a, const JoltagePresses& b) {
+			return JoltagePresses{a.presses + b.presses, a.memo_hits + b.memo_hits};
+		});
+	ResultMemo& memo = joltage_memo();
+	if (memo.enabled()) {
+		memo.flush();
+		add_counter("joltage_memo_hits", total.memo_hits);
+	}
+	return total.presses;
+}
+
+void solve_parts(const vector<Machine>& machines, ostream& out) {
+	const int result_1 = time_phase("part_1", [&machines] { return get_min_steps_for_lights(machines); });
+	out << "Part 1 : result=" << result_1 << "\n";
+
+	const int result_2 = time_phase("part_2", [&machines] { return get_min_presses_joltage(machines); });
+	out << "Part 2 : result=" << result_2 << "\n";
+}
+
+int solve(const vector<string_view>& input_lines, ostream& out) {
+	vector<Machine> machines(input_lines.size(), Machine{});
+	time_phase("parse", [&] {
+		parse_input(machines, input_lines);
+		return machines.size();
+	});
+	solve_parts(machines, out);
+	return 0;
 }
 
-int solve(vector<string>& input_lines) {
+// the binary model is the packed machines, then all their buttons, then all their joltages
+void write_model(const vector<string_view>& input_lines, ostream& os) {
 	vector<Machine> machines(input_lines.size(), Machine{});
 	parse_input(machines, input_lines);
 
-	auto solve_1 = [](const vector<Machine>& m) {
-		int result = get_min_steps_for_lights(m);
-		cout << "Part 1 : result=" << result << "\n";
-	};
-	time_wrap(solve_1, machines);
+	vector<PackedMachine> packed;
+	vector<int> buttons;
+	vector<int> joltages;
+	packed.reserve(machines.size());
+	for (const Machine& machine : machines) {
+		packed.push_back(PackedMachine{
+			machine.final_state,
+			machine.bit_size,
+			uint32_t(buttons.size()),
+			uint32_t(machine.buttons.size()),
+			uint32_t(joltages.size()),
+			uint32_t(machine.joltage_requirements.size())});
+		buttons.insert(buttons.end(), machine.buttons.begin(), machine.buttons.end());
+		const vector<int>& requirements = machine.joltage_requirements;
+		joltages.insert(joltages.end(), requirements.begin(), requirements.end());
+	}
 
-	auto solve_2 = [](const vector<Machine>& m) {
-		int result = get_min_presses_joltage(m);
-		cout << "Part 2 : result=" << result << "\n";
-	};
-	time_wrap(solve_2, machines);
+	BinaryModelWriter writer(2025, 10, MODEL_SCHEMA);
+	writer.add(packed);
+	writer.add(buttons);
+	writer.add(joltages);
+	writer.write(os);
+}
+
+// the solvers take Machines, so the packed records are copied out, without any parsing
+void unpack_machines(vector<Machine>& results, const BinaryModel& model) {
+	const span<const PackedMachine> packed = model.section<PackedMachine>(0);
+	const span<const int> buttons = model.section<int>(1);
+	const span<const int> joltages = model.section<int>(2);
+
+	results.assign(packed.size(), Machine{});
+	for (size_t i = 0; i < packed.size(); ++i) {
+		const PackedMachine& record = packed[i];
+		// the lights are shifted by up to bit_size - 1, one joltage per light, so bit_size has to fit an int
+		if (size_t(record.first_button) + record.n_buttons > buttons.size() ||
+			size_t(record.first_joltage) + record.n_joltages > joltages.size() || record.bit_size <= 0 ||
+			record.bit_size >= 32 || record.n_joltages > uint32_t(record.bit_size)) {
+			throw runtime_error("Invalid packed machine=" + to_string(i));
+		}
+		Machine& machine = results[i];
+		machine.final_state = record.final_state;
+		machine.bit_size = record.bit_size;
+		const span<const int> machine_buttons = buttons.subspan(record.first_button, record.n_buttons);
+		const span<const int> machine_joltages = joltages.subspan(record.first_joltage, record.n_joltages);
+		machine.buttons.assign(machine_buttons.begin(), machine_buttons.end());
+		machine.joltage_requirements.assign(machine_joltages.begin(), machine_joltages.end());
+	}
+}
 
+int solve_model(const string& path, ostream& out) {
+	const BinaryModel model =
+		time_phase("load", [&path] { return BinaryModel::map(path, 2025, 10, MODEL_SCHEMA); });
+	vector<Machine> machines;
+	time_phase("unpack", [&] {
+		unpack_machines(machines, model);
+		return machines.size();
+	});
+	solve_parts(machines, out);
 	return 0;
 }
 
-void get_input_as_vector(vector<string>& input) {
-	string line;
-	while (getline(cin, line)) {
-		input.push_back(line);
+// both parts in one pass, machine by machine as they are read
+int solve_stream(LineStream& stream, ostream& out) {
+	ScopedPhase phase("stream");
+	int result_1 = 0;
+	int result_2 = 0;
+	vector<string_view> lines;
+	vector<Machine> machines;
+	while (stream.next(lines)) {
+		machines.assign(lines.size(), Machine{});
+		parse_input(machines, lines);
+		result_1 += get_min_steps_for_lights(machines);
+		result_2 += get_min_presses_joltage(machines);
 	}
+	out << "Part 1 : result=" << result_1 << "\n";
+	out << "Part 2 : result=" << result_2 << "\n";
+	return 0;
 }
 
-int main() {
-	vector<string> input;
-	get_input_as_vector(input);
+// scale machines with 3 to 8 lights and 3 to 10 buttons.
+// The light pattern is the result of pressing a random subset of buttons once, and the
+// joltages of pressing every button 0 to 2 times, so both parts always have a solution.
+// (joltages are kept far smaller than the real input, so that the part 2 BFS finishes)
+void generate_input(ostream& os, const size_t scale, mt19937_64& rng) {
+	for (size_t m = 0; m < scale; ++m) {
+		const size_t n_lights = random_between(rng, 3, 8);
+		const size_t n_buttons = random_between(rng, 3, 10);
+
+		vector<vector<size_t>> buttons(n_buttons);
+		for (vector<size_t>& button : buttons) {
+			for (size_t light = 0; light < n_lights; ++light) {
+				if (random_chance(rng, 0.4))
+					button.push_back(light);
+			}
+			if (button.empty())
+				button.push_back(random_between(rng, 0, n_lights - 1));
+		}
+
+		string lights(n_lights, '.');
+		vector<u_ll> joltages(n_lights, 0);
+		for (const vector<size_t>& button : buttons) {
+			const bool toggle = random_chance(rng, 0.5);
+			const u_ll presses = random_between(rng, 0, 2);
+			for (const size_t light : button) {
+				if (toggle)
+					lights[light] = lights[light] == '.' ? MACHINE_INDICATOR_ON : '.';
+				joltages[light] += presses;
+			}
+		}
 
-	if (0 != solve(input)) {
-		return EXIT_FAILURE;
+		os << '[' << lights << ']';
+		for (const vector<size_t>& button : buttons) {
+			os << ' ' << PARENS_OPEN;
+			for (size_t i = 0; i < button.size(); ++i) {
+				os << (i ? "," : "") << button[i];
+			}
+			os << PARENS_CLOSE;
+		}
+		os << ' ' << '{';
+		for (size_t i = 0; i < n_lights; ++i) {
+			os << (i ? "," : "") << joltages[i];
+		}
+		os << BRACES_END << '\n';
 	}
-	return EXIT_SUCCESS;
 }
+
+void benchmark(Benchmark& bench, const vector<string_view>& input_lines) {
+	bench.run("parse", [&input_lines] {
+		vector<Machine> machines(input_lines.size(), Machine{});
+		parse_input(machines, input_lines);
+		return machines.size();
+	});
+
+	vector<Machine> machines(input_lines.size(), Machine{});
+	parse_input(machines, input_lines);
+	bench.run("part_1", [&machines] { return get_min_steps_for_lights(machines); });
+	bench.run("part_1/reference", [&machines] { return get_min_steps_for_lights_bfs(machines); });
+	bench.run("part_2", [&machines] { return get_min_presses_joltage(machines); });
+}
+
+void verify(Verifier& verifier, const vector<string_view>& input_lines) {
+	vector<Machine> machines(input_lines.size(), Machine{});
+	parse_input(machines, input_lines);
+	verifier.check(
+		"part_1",
+		[&machines] { return get_min_steps_for_lights_bfs(machines); },
+		[&machines] { return get_min_steps_for_lights(machines); });
+}
+
+const RegisterSolver registered{
+	{2025, 10, "Factory", solve, benchmark, generate_input, solve_stream, write_model, solve_model, verify}};
+
+#ifndef AOC_DRIVER
+int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+#endif
@@ -0,0 +1,328 @@
+// One driver for every registered solver, so a batch of puzzles pays for process startup,
+// iostream init and the instrumentation setup once.
+//
+// mkdir -p ./build && g++-15 -std=c++23 -O2 aoc.cpp -o ./build/aoc.tsk
+// ./build/aoc.tsk 2025 7 < ./io/input1.txt
+// ./build/aoc.tsk 2025 1,3,7 --input-dir ./io/2025        (reads ./io/2025/01.txt, ...)
+// ./build/aoc.tsk 2025 all --input-dir ./io/2025 [--bench 10] [--perf] [--trace trace.json]
+// ./build/aoc.tsk 2025 all --input-dir ./io/2025 --bench --compare-baseline baseline.csv [--noise 10]
+// ./build/aoc.tsk 2025 7 --stream < ./io/input1.txt                (days 1, 3, 7 and 10 only)
+// ./build/aoc.tsk 2025 7 --batch ./corpus [--out results.jsonl] [--max-in-flight n] [--threads n]
+// ./build/aoc.tsk 2025 8 --compile-model 08.model < ./io/input1.txt; ./build/aoc.tsk 2025 8 --model 08.model
+// ./build/aoc.tsk 2025 all --input-dir ./io/2025 --cache ~/.cache/aoc [--cache-max-mb 256] [--no-cache]
+// ./build/aoc.tsk 2025 all --verify --input-dir ./io/2025 [--sizes 10,100,1000] [--seeds 3]
+// ./build/aoc.tsk --serve /tmp/aoc.sock [--handlers 4]          (requests come from aoc_client.cpp)
+// ./build/aoc.tsk --list
+//
+// Every day file is compiled into its own namespace, with its main() left out by AOC_DRIVER.
+// All the headers the days include are included first, so that the includes inside the
+// namespaces are no-ops.
+
+#define AOC_DRIVER
+
+#include "common/batch.h"
+#include "common/bench.h"
+#include "common/binary_model.h"
+#include "common/daemon.h"
+#include "common/generate.h"
+#include "common/input.h"
+#include "common/line_stream.h"
+#include "common/log.h"
+#include "common/parallel.h"
+#include "common/parse_number.h"
+#include "common/phase.h"
+#include "common/registry.h"
+#include "common/result_cache.h"
+#include "common/structural_index.h"
+#include "common/threads.h"
+#include "common/verify.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <random>
+#include <set>
+#include <span>
+#include <sstream>
+#include <stack>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace aoc2025_01 {
+#include "2025/01_SecretEntrance.cpp"
+}
+namespace aoc2025_02 {
+#include "2025/02_GiftShop.cpp"
+}
+namespace aoc2025_03 {
+#include "2025/03_Lobby.cpp"
+}
+namespace aoc2025_04 {
+#include "2025/04_PrintingDepartment.cpp"
+}
+namespace aoc2025_05 {
+#include "2025/05_Cafeteria.cpp"
+}
+namespace aoc2025_06 {
+#include "2025/06_TrashCompactor.cpp"
+}
+namespace aoc2025_07 {
+#include "2025/07_Laboratory.cpp"
+}
+namespace aoc2025_08 {
+#include "2025/08_Playground.cpp"
+}
+namespace aoc2025_09 {
+#include "2025/09_MovieTheater.cpp"
+}
+namespace aoc2025_10 {
+#include "2025/10_Factory.cpp"
+}
+
+using namespace std;
+
+struct DriverOptions {
+	bool list = false;
+	bool verify = false; // --verify, which can do without inputs
+	vector<const Solver*> solvers;
+	string input_dir; // stdin when empty, which only works for a single day
+};
+
+// "7", "1,3,7" or "all"
+vector<const Solver*> parse_days(const int year, const string_view days) {
+	vector<const Solver*> result;
+	for (const Solver& solver : solver_registry().all()) {
+		if (solver.year == year && "all" == days)
+			result.push_back(&solver);
+	}
+	if ("all" == days)
+		return result;
+
+	for (const size_t day : parse_size_list(days)) {
+		const Solver* solver = solver_registry().find(year, static_cast<int>(day));
+		if (!solver) {
+			throw runtime_error("No solver for year=" + to_string(year) + " day=" + to_string(day));
+		}
+		result.push_back(solver);
+	}
+	return result;
+}
+
+/**
+ * @brief Parses `<year> <days> [--input-dir dir]` or `--list`, and notes `--verify`, the one mode that does
+ *        not need an input for several days. The other options (--bench, --generate, --perf, --trace, ...)
+ *        are left to the shared parsers.
+ */
+DriverOptions parse_driver_args(const int argc, char** argv) {
+	DriverOptions options;
+	vector<string_view> positional;
+	for (int i = 1; i < argc; ++i) {
+		const string_view arg = argv[i];
+		if ("--list" == arg) {
+			options.list = true;
+		} else if ("--input-dir" == arg && i + 1 < argc) {
+			options.input_dir = argv[++i];
+		} else if ("--bench" == arg && i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+			++i; // the repetitions
+		} else if ("--verify" == arg) {
+			options.verify = true;
+		} else if (arg.starts_with("--")) {
+			// an option of the shared parsers, which all take a value but for the flags below
+			const bool flag =
+				"--bench" == arg || "--perf" == arg || "--alloc-strict" == arg || "--stream" == arg ||
+				"--no-cache" == arg;
+			if (!flag && i + 1 < argc)
+				++i;
+		} else {
+			positional.push_back(arg);
+		}
+	}
+	if (options.list)
+		return options;
+	if (2 != positional.size()) {
+		throw runtime_error("Usage: aoc <year> <day|day,day,...|all> [--input-dir dir] | --list");
+	}
+	options.solvers = parse_days(parse_int<int>(positional[0]), positional[1]);
+	if (options.solvers.size() > 1 && options.input_dir.empty() && !options.verify) {
+		throw runtime_error("Several days need --input-dir, stdin only holds one input");
+	}
+	return options;
+}
+
+Input load_input(const DriverOptions& options, const Solver& solver) {
+	if (options.input_dir.empty())
+		return Input::from_stdin();
+	char name[16];
+	snprintf(name, sizeof(name), "/%02d.txt", solver.day);
+	return Input::from_file(options.input_dir + name);
+}
+
+// stdin, or the day's file of --input-dir
+int open_input(const DriverOptions& options, const Solver& solver) {
+	if (options.input_dir.empty())
+		return STDIN_FILENO;
+	char name[16];
+	snprintf(name, sizeof(name), "/%02d.txt", solver.day);
+	const string path = options.input_dir + name;
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw runtime_error("Cannot open input path=" + path);
+	}
+	return fd;
+}
+
+int run_driver(const int argc, char** argv) {
+	ios::sync_with_stdio(false);
+	parse_phase_args(argc, argv);
+	parse_thread_args(argc, argv);
+	parse_cache_args(argc, argv);
+
+	// a long-running process for any day, see daemon.h
+	DaemonOptions daemon_options;
+	if (parse_daemon_args(daemon_options, argc, argv)) {
+		const auto solve = [](const int year, const int day, const string_view part, const Input& input,
+							  ostream& out) {
+			const Solver* solver = solver_registry().find(year, day);
+			if (!solver) {
+				throw runtime_error("No solver for year=" + to_string(year) + " day=" + to_string(day));
+			}
+			return solve_cached(*solver, input, out, part);
+		};
+		return run_daemon(daemon_options, solve);
+	}
+
+	const DriverOptions options = parse_driver_args(argc, argv);
+	if (options.list) {
+		for (const Solver& solver : solver_registry().all()) {
+			cout << solver.year << " " << solver.day << " : " << solver.title << "\n";
+		}
+		return EXIT_SUCCESS;
+	}
+
+	GenerateOptions generate_options;
+	if (parse_generate_args(generate_options, argc, argv)) {
+		if (1 != options.solvers.size()) {
+			cerr << "--generate needs a single day\n";
+			return EXIT_FAILURE;
+		}
+		return run_generator(generate_options, options.solvers[0]->generate_input);
+	}
+
+	BatchOptions batch_options;
+	if (parse_batch_args(batch_options, argc, argv)) {
+		if (1 != options.solvers.size()) {
+			cerr << "--batch needs a single day\n";
+			return EXIT_FAILURE;
+		}
+		const Solver& solver = *options.solvers[0];
+		return run_batch(batch_options, [&solver](const Input& input, ostream& out) {
+			return solve_cached(solver, input, out);
+		});
+	}
+
+	ModelOptions model_options;
+	if (parse_model_args(model_options, argc, argv)) {
+		if (1 != options.solvers.size() || !options.solvers[0]->write_model) {
+			cerr << "--compile-model / --model need a single day with a binary model\n";
+			return EXIT_FAILURE;
+		}
+		return run_model(model_options, options.solvers[0]->write_model, options.solvers[0]->solve_model);
+	}
+
+	VerifyOptions verify_options;
+	if (parse_verify_args(verify_options, argc, argv)) {
+		// only the days with reference / optimized pairs, on their input when there is one: their file of
+		// --input-dir, or stdin for a single day. Several days without --input-dir only check generated inputs.
+		int status = EXIT_SUCCESS;
+		bool verified = false;
+		for (const Solver* solver : options.solvers) {
+			if (!solver->verify)
+				continue;
+			verified = true;
+			cout << "Day " << solver->day << " : " << solver->title << "\n";
+			const bool has_input = !options.input_dir.empty() ||
+								   (1 == options.solvers.size() && !isatty(STDIN_FILENO));
+			const Input input = has_input ? load_input(options, *solver) : Input::from_string("");
+			status |= run_verification(
+				verify_options, has_input ? &input : nullptr, solver->verify, solver->generate_input, cout);
+		}
+		if (!verified) {
+			cerr << "--verify : none of these days has a reference to check against\n";
+			return EXIT_FAILURE;
+		}
+		return status;
+	}
+
+	if (parse_stream_args(argc, argv)) {
+		int status = EXIT_SUCCESS;
+		for (const Solver* solver : options.solvers) {
+			cout << "Day " << solver->day << " : " << solver->title << "\n";
+			if (!solver->solve_stream) {
+				cerr << "Day " << solver->day << " cannot run on a stream\n";
+				status = EXIT_FAILURE;
+				continue;
+			}
+			ScopedPhase day_phase(solver_id(*solver));
+			const int fd = open_input(options, *solver);
+			{
+				LineStream stream(fd);
+				status |= solver->solve_stream(stream, cout);
+			}
+			if (STDIN_FILENO != fd)
+				close(fd);
+		}
+		print_phase_report();
+		return status;
+	}
+
+	BenchOptions bench_options;
+	const bool bench = parse_bench_args(bench_options, argc, argv);
+
+	int status = EXIT_SUCCESS;
+	for (const Solver* solver : options.solvers) {
+		cout << "Day " << solver->day << " : " << solver->title << "\n";
+		if (bench && !bench_options.sweep_sizes.empty()) {
+			status |= run_benchmarks(bench_options, *solver);
+			continue;
+		}
+
+		ScopedPhase day_phase(solver_id(*solver));
+		const Input input = time_phase("load", [&] { return load_input(options, *solver); });
+		if (bench) {
+			status |= run_benchmark_report(bench_options, solver_id(*solver), input, solver->benchmark, cout);
+		} else if (0 != solve_cached(*solver, input, cout)) {
+			status = EXIT_FAILURE;
+		}
+	}
+	if (!bench) {
+		print_phase_report();
+	}
+	return status;
+}
+
+// usage errors, unknown days and unreadable inputs end the run with their message rather than an abort
+int main(int argc, char** argv) {
+	try {
+		return run_driver(argc, argv);
+	} catch (const exception& e) {
+		cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,133 @@
+// The local caller of the solver daemon (`aoc.tsk --serve`, see common/daemon.h): sends one request
+// and prints the JSON line of the response.
+//
+// mkdir -p ./build && g++-15 -std=c++23 -O2 aoc_client.cpp -o ./build/aoc_client.tsk
+// ./build/aoc_client.tsk --socket /tmp/aoc.sock 2025 7 [--part 1] < ./io/input1.txt
+// ./build/aoc_client.tsk --socket /tmp/aoc.sock 2025 7 --path ./io/input1.txt [--repeat 100]
+// ./build/aoc_client.tsk --socket /tmp/aoc.sock --shutdown
+//
+// With --repeat, the request is sent n times over the same connection, and the round trip times
+// (the latency a caller sees) are summarised on stderr.
+
+#include "common/daemon.h"
+#include "common/input.h"
+#include "common/parse_number.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+struct ClientOptions {
+	string socket_path = "/tmp/aoc.sock";
+	int year = 0;
+	int day = 0;
+	string part = "all";
+	string path; // stdin when empty
+	size_t repeat = 1;
+	bool shutdown = false;
+};
+
+ClientOptions parse_client_args(const int argc, char** argv) {
+	ClientOptions options;
+	vector<string_view> positional;
+	for (int i = 1; i < argc; ++i) {
+		const string_view arg = argv[i];
+		if ("--shutdown" == arg) {
+			options.shutdown = true;
+		} else if (arg.starts_with("--") && i + 1 < argc) {
+			const string value = argv[++i];
+			if ("--socket" == arg) {
+				options.socket_path = value;
+			} else if ("--part" == arg) {
+				options.part = value;
+			} else if ("--path" == arg) {
+				// the daemon may run elsewhere in the tree
+				options.path = filesystem::absolute(value).string();
+			} else if ("--repeat" == arg) {
+				options.repeat = max<size_t>(1, parse_uint<size_t>(value));
+			} else {
+				throw runtime_error("Unknown option=" + string(arg));
+			}
+		} else {
+			positional.push_back(arg);
+		}
+	}
+	if (!options.shutdown) {
+		if (2 != positional.size()) {
+			throw runtime_error("Usage: aoc_client [--socket path] <year> <day> [--part 1|2|all] "
+								"[--path input] [--repeat n] | --shutdown");
+		}
+		options.year = parse_int<int>(positional[0]);
+		options.day = parse_int<int>(positional[1]);
+	}
+	return options;
+}
+
+int run_client(const int argc, char** argv) {
+	const ClientOptions options = parse_client_args(argc, argv);
+	const int fd = connect_daemon(options.socket_path);
+	SocketReader reader(fd);
+	string response;
+
+	if (options.shutdown) {
+		const bool ok = write_all(fd, "shutdown\n") && reader.read_line(response, SIZE_MAX);
+		cout << response << "\n";
+		close(fd);
+		return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// the request is built once, the input included
+	string request;
+	if (options.path.empty()) {
+		const Input input = Input::from_stdin();
+		request = daemon_bytes_request(options.year, options.day, options.part, input.text().size());
+		request += input.text();
+	} else {
+		request = daemon_path_request(options.year, options.day, options.part, options.path);
+	}
+
+	bool ok = true;
+	vector<double> round_trips;
+	for (size_t i = 0; i < options.repeat; ++i) {
+		const auto start = chrono::steady_clock::now();
+		if (!write_all(fd, request) || !reader.read_line(response, SIZE_MAX)) {
+			cerr << "The daemon closed the connection\n";
+			ok = false;
+			break;
+		}
+		round_trips.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+		ok = ok && response.starts_with("{\"status\":\"ok\"");
+		if (0 == i) {
+			cout << response << "\n";
+		}
+	}
+	close(fd);
+
+	if (options.repeat > 1 && !round_trips.empty()) {
+		sort(round_trips.begin(), round_trips.end());
+		cerr << "requests=" << round_trips.size() << " min_us=" << round_trips.front() * 1e6
+			 << " median_us=" << round_trips[round_trips.size() / 2] * 1e6
+			 << " max_us=" << round_trips.back() * 1e6 << "\n";
+	}
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// usage errors and a daemon that is not there end the run with their message rather than an abort
+int main(int argc, char** argv) {
+	try {
+		return run_client(argc, argv);
+	} catch (const exception& e) {
+		cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,159 @@
+#include "../common/parse_number.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+using u_ll = unsigned long long;
+using ll = long long;
+
+// Microbenchmark of the shared number parsing against what the solvers used to do,
+// ie. stoi / stoull / stod on a temporary substr.
+//
+// Fields are generated to look like the puzzle inputs:
+//   rotations    "L68"                         (day 1)
+//   ids          "1188511880"                  (days 2, 5)
+//   coordinates  "57618"                       (days 8, 9)
+//   joltages     "191"                         (day 10)
+//
+// mkdir -p ./build && g++-15 -std=c++23 -O2 bench/parse_number_bench.cpp -o ./build/parse_number_bench.tsk
+// ./build/parse_number_bench.tsk [num_fields]
+
+constexpr size_t REPETITIONS = 7;
+
+struct Fields {
+	string name;
+	string text;				// all fields back to back, like the input buffer
+	vector<string_view> fields; // views into text
+};
+
+Fields make_fields(
+	const string& name,
+	const size_t n,
+	mt19937_64& rng,
+	function<string(mt19937_64&)> make_one) {
+	Fields result{name, {}, {}};
+	vector<pair<size_t, size_t>> spans;
+	spans.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		const string one = make_one(rng);
+		spans.emplace_back(result.text.size(), one.size());
+		result.text += one;
+		result.text += '\n';
+	}
+	result.fields.reserve(n);
+	for (const auto& [start, size] : spans) {
+		result.fields.emplace_back(result.text.data() + start, size);
+	}
+	return result;
+}
+
+// best of REPETITIONS, in nanoseconds per field
+template <typename F>
+double time_per_field(const Fields& fields, F&& parse_all) {
+	double best = 1e300;
+	for (size_t rep = 0; rep < REPETITIONS; ++rep) {
+		auto start = chrono::steady_clock::now();
+		volatile auto sink = parse_all(fields.fields);
+		auto end = chrono::steady_clock::now();
+		(void)sink;
+		chrono::duration<double, nano> elapsed = end - start;
+		best = min(best, elapsed.count() / fields.fields.size());
+	}
+	return best;
+}
+
+template <typename FOld, typename FNew>
+void compare(const Fields& fields, FOld&& old_parse, FNew&& new_parse) {
+	if (old_parse(fields.fields) != new_parse(fields.fields)) {
+		cerr << "Mismatch for fields=" << fields.name << "\n";
+		exit(EXIT_FAILURE);
+	}
+	const double old_ns = time_per_field(fields, old_parse);
+	const double new_ns = time_per_field(fields, new_parse);
+	cout << fields.name << " : substr+sto_ns=" << old_ns << " parse_number_ns=" << new_ns
+		 << " speedup=" << old_ns / new_ns << "\n";
+}
+
+int main(int argc, char** argv) {
+	const size_t n = argc > 1 ? stoull(argv[1]) : 1000000;
+	mt19937_64 rng(2025);
+
+	const Fields rotations = make_fields("rotations", n, rng, [](mt19937_64& r) {
+		return string(1, r() % 2 ? 'L' : 'R') + to_string(r() % 1000);
+	});
+	compare(
+		rotations,
+		[](const vector<string_view>& fields) {
+			ll sum = 0;
+			for (const string_view f : fields)
+				sum += stoi(string{f.substr(1)});
+			return sum;
+		},
+		[](const vector<string_view>& fields) {
+			ll sum = 0;
+			for (const string_view f : fields)
+				sum += parse_int<int>(f.substr(1));
+			return sum;
+		});
+
+	const Fields ids =
+		make_fields("ids", n, rng, [](mt19937_64& r) { return to_string(r() % 10000000000ULL); });
+	compare(
+		ids,
+		[](const vector<string_view>& fields) {
+			u_ll sum = 0;
+			for (const string_view f : fields)
+				sum += stoull(string{f});
+			return sum;
+		},
+		[](const vector<string_view>& fields) {
+			u_ll sum = 0;
+			for (const string_view f : fields)
+				sum += parse_uint<u_ll>(f);
+			return sum;
+		});
+
+	const Fields coordinates =
+		make_fields("coordinates", n, rng, [](mt19937_64& r) { return to_string(r() % 100000); });
+	compare(
+		coordinates,
+		[](const vector<string_view>& fields) {
+			double sum = 0;
+			for (const string_view f : fields)
+				sum += stod(string{f});
+			return sum;
+		},
+		[](const vector<string_view>& fields) {
+			double sum = 0;
+			for (const string_view f : fields)
+				sum += parse_double(f);
+			return sum;
+		});
+
+	const Fields joltages =
+		make_fields("joltages", n, rng, [](mt19937_64& r) { return to_string(r() % 300); });
+	compare(
+		joltages,
+		[](const vector<string_view>& fields) {
+			ll sum = 0;
+			for (const string_view f : fields)
+				sum += stoi(string{f});
+			return sum;
+		},
+		[](const vector<string_view>& fields) {
+			ll sum = 0;
+			for (const string_view f : fields)
+				sum += parse_int<int>(f);
+			return sum;
+		});
+
+	return EXIT_SUCCESS;
+}
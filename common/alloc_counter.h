@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+#ifdef AOC_COUNT_ALLOCATIONS
+#include <malloc.h>
+#endif
+
+/**
+ * Allocation accounting.
+ *
+ * Build with -DAOC_COUNT_ALLOCATIONS to replace the global operator new / delete with counting
+ * versions. Each thread counts its own allocations, bytes and live bytes, so a phase can take the
+ * difference, and the peak of live bytes, over its scope (see ScopedPhase and Benchmark).
+ * Without the flag nothing is replaced and every count stays 0.
+ *
+ * Sizes come from malloc_usable_size, so they include the allocator's rounding.
+ * Over-aligned allocations (operator new with align_val_t) are not counted.
+ *
+ *     g++ -std=c++23 -O2 -DAOC_COUNT_ALLOCATIONS 2025/08_Playground.cpp -o ./build/day.tsk
+ */
+
+#ifdef AOC_COUNT_ALLOCATIONS
+constexpr bool ALLOCATION_COUNTING = true;
+#else
+constexpr bool ALLOCATION_COUNTING = false;
+#endif
+
+struct AllocationCounts {
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+	int64_t live_bytes = 0; // can go negative on a thread that frees what another allocated
+	int64_t peak_live_bytes = 0;
+};
+
+inline AllocationCounts& thread_allocation_counts() {
+	thread_local AllocationCounts counts;
+	return counts;
+}
+
+/**
+ * @brief Measures the allocations of this thread over a scope. Scopes nest: the peak of an inner
+ *        scope still counts towards the peak of the outer one.
+ */
+class AllocationScope {
+public:
+	AllocationScope() : start_{thread_allocation_counts()} {
+		// track the peak of this scope alone, and restore the outer one in finish()
+		thread_allocation_counts().peak_live_bytes = start_.live_bytes;
+	}
+
+	AllocationScope(const AllocationScope&) = delete;
+	AllocationScope& operator=(const AllocationScope&) = delete;
+
+	~AllocationScope() { finish(); }
+
+	// allocations and bytes since the start, and the peak of live bytes above the start
+	AllocationCounts finish() {
+		AllocationCounts& counts = thread_allocation_counts();
+		if (!finished_) {
+			finished_ = true;
+			result_ = AllocationCounts{
+				counts.allocations - start_.allocations,
+				counts.bytes - start_.bytes,
+				counts.live_bytes - start_.live_bytes,
+				counts.peak_live_bytes - start_.live_bytes};
+			counts.peak_live_bytes = std::max(counts.peak_live_bytes, start_.peak_live_bytes);
+		}
+		return result_;
+	}
+
+private:
+	AllocationCounts start_;
+	AllocationCounts result_;
+	bool finished_ = false;
+};
+
+// peak resident set size of the whole process so far, in KiB
+inline long peak_rss_kb() {
+	rusage usage{};
+	if (0 != getrusage(RUSAGE_SELF, &usage))
+		return 0;
+	return usage.ru_maxrss;
+}
+
+#ifdef AOC_COUNT_ALLOCATIONS
+// Replacements of the global allocation functions. Each day is a single translation unit,
+// so defining them in this header is fine.
+inline void* counted_allocate(const std::size_t size) {
+	void* p = std::malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	AllocationCounts& counts = thread_allocation_counts();
+	const int64_t usable = static_cast<int64_t>(malloc_usable_size(p));
+	++counts.allocations;
+	counts.bytes += usable;
+	counts.live_bytes += usable;
+	counts.peak_live_bytes = std::max(counts.peak_live_bytes, counts.live_bytes);
+	return p;
+}
+
+inline void counted_free(void* p) noexcept {
+	if (!p)
+		return;
+	thread_allocation_counts().live_bytes -= static_cast<int64_t>(malloc_usable_size(p));
+	std::free(p);
+}
+
+void* operator new(std::size_t size) { return counted_allocate(size); }
+void* operator new[](std::size_t size) { return counted_allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return counted_allocate(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return counted_allocate(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+#endif
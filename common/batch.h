@@ -0,0 +1,230 @@
+#pragma once
+
+#include "input.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <semaphore>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Batch mode: one solver over a whole corpus of inputs, on every core.
+ *
+ * The inputs come from a directory (every regular file, in name order) or a manifest file (one path
+ * per line, relative to the manifest, '#' starts a comment). Every input is one task on the shared
+ * work-stealing pool, which loads it, solves it and streams a JSON line with its answers and timings
+ * as soon as it is done, so the lines come out in completion order, tagged with their index.
+ *
+ * At most `max_in_flight` inputs are loaded at any time (2 per thread by default), so memory stays
+ * bounded however big the corpus is.
+ *
+ *     ./build/aoc.tsk 2025 7 --batch ./corpus [--out results.jsonl] [--max-in-flight 16] [--threads 8]
+ *
+ *     {"index":0,"path":"./corpus/a.txt","status":"ok","bytes":19283,"load_seconds":1.2e-05,
+ *      "solve_seconds":0.0021,"answers":["Part 1 : number_splits=1562","Part 2 : number_splits=24292"]}
+ */
+
+struct BatchOptions {
+	std::string source; // a directory or a manifest
+	std::string out_path; // stdout when empty
+	size_t max_in_flight = 0; // 0 means 2 per thread
+};
+
+/**
+ * @brief Parses `--batch <dir|manifest> [--out path] [--max-in-flight n]`.
+ * @return whether batch mode was requested
+ */
+inline bool parse_batch_args(BatchOptions& options, const int argc, char** argv) {
+	bool requested = false;
+	for (int i = 1; i + 1 < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--batch" == arg) {
+			requested = true;
+			options.source = argv[++i];
+		} else if ("--out" == arg) {
+			options.out_path = argv[++i];
+		} else if ("--max-in-flight" == arg) {
+			options.max_in_flight = std::strtoull(argv[++i], nullptr, 10);
+		}
+	}
+	return requested;
+}
+
+inline std::vector<std::string> list_batch_inputs(const std::string& source) {
+	namespace fs = std::filesystem;
+	std::vector<std::string> paths;
+	if (fs::is_directory(source)) {
+		for (const fs::directory_entry& entry : fs::directory_iterator(source)) {
+			if (entry.is_regular_file())
+				paths.push_back(entry.path().string());
+		}
+		std::sort(paths.begin(), paths.end());
+		return paths;
+	}
+
+	std::ifstream manifest(source);
+	if (!manifest) {
+		throw std::runtime_error("Cannot open batch source=" + source);
+	}
+	const fs::path base = fs::path(source).parent_path();
+	std::string line;
+	while (std::getline(manifest, line)) {
+		line.erase(std::find(line.begin(), line.end(), '#'), line.end());
+		while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+			line.pop_back();
+		if (line.empty())
+			continue;
+		const fs::path path(line);
+		paths.push_back(path.is_absolute() ? line : (base / path).string());
+	}
+	return paths;
+}
+
+inline void write_json_string(std::ostream& os, const std::string_view text) {
+	os << '"';
+	for (const char c : text) {
+		switch (c) {
+		case '"':
+			os << "\\\"";
+			break;
+		case '\\':
+			os << "\\\\";
+			break;
+		case '\n':
+			os << "\\n";
+			break;
+		case '\t':
+			os << "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				os << ' ';
+			} else {
+				os << c;
+			}
+		}
+	}
+	os << '"';
+}
+
+// what solve wrote, one answer per line, as a JSON array of strings
+inline void write_json_answers(std::ostream& os, std::string_view answers) {
+	os << '[';
+	bool first = true;
+	while (!answers.empty()) {
+		const size_t newline = std::min(answers.find('\n'), answers.size());
+		if (newline > 0) {
+			os << (first ? "" : ",");
+			write_json_string(os, answers.substr(0, newline));
+			first = false;
+		}
+		answers.remove_prefix(std::min(newline + 1, answers.size()));
+	}
+	os << ']';
+}
+
+struct BatchResult {
+	size_t index;
+	std::string path;
+	bool ok;
+	std::string error;
+	size_t bytes;
+	double load_seconds;
+	double solve_seconds;
+	std::string answers; // what solve wrote, one answer per line
+};
+
+inline void write_batch_result(std::ostream& os, const BatchResult& result) {
+	os << "{\"index\":" << result.index << ",\"path\":";
+	write_json_string(os, result.path);
+	os << ",\"status\":\"" << (result.ok ? "ok" : "error") << "\",\"bytes\":" << result.bytes
+	   << ",\"load_seconds\":" << result.load_seconds << ",\"solve_seconds\":" << result.solve_seconds;
+	if (!result.ok) {
+		os << ",\"error\":";
+		write_json_string(os, result.error);
+	}
+	os << ",\"answers\":";
+	write_json_answers(os, result.answers);
+	os << "}\n";
+}
+
+/**
+ * @brief Runs solve(input, out) over every input of the batch, see above.
+ * @return EXIT_FAILURE if any input failed
+ */
+template <typename FSolve>
+int run_batch(const BatchOptions& options, FSolve&& solve) {
+	const std::vector<std::string> paths = list_batch_inputs(options.source);
+
+	std::ofstream out_file;
+	if (!options.out_path.empty()) {
+		out_file.open(options.out_path);
+		if (!out_file) {
+			std::cerr << "Cannot open batch output path=" << options.out_path << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+	std::ostream& out = options.out_path.empty() ? std::cout : out_file;
+
+	ThreadPool& pool = shared_thread_pool();
+	const size_t max_in_flight = options.max_in_flight ? options.max_in_flight : 2 * pool.size();
+	std::counting_semaphore<> slots(static_cast<std::ptrdiff_t>(max_in_flight));
+	std::mutex out_mutex;
+	size_t n_failed = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < paths.size(); ++i) {
+		// blocks until an input is done, which is what bounds the memory
+		slots.acquire();
+		pool.submit([&, i] {
+			BatchResult result{i, paths[i], true, {}, 0, 0.0, 0.0, {}};
+			try {
+				const auto load_start = std::chrono::steady_clock::now();
+				const Input input = Input::from_file(paths[i]);
+				// solvers index their first line, so one empty file would take the whole batch down
+				if (input.blank()) {
+					throw std::runtime_error("Empty input");
+				}
+				const auto solve_start = std::chrono::steady_clock::now();
+				std::ostringstream answers;
+				result.ok = 0 == solve(input, answers);
+				const auto solve_end = std::chrono::steady_clock::now();
+
+				result.bytes = input.text().size();
+				result.load_seconds = std::chrono::duration<double>(solve_start - load_start).count();
+				result.solve_seconds = std::chrono::duration<double>(solve_end - solve_start).count();
+				result.answers = std::move(answers).str();
+			} catch (const std::exception& e) {
+				result.ok = false;
+				result.error = e.what();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(out_mutex);
+				write_batch_result(out, result);
+				out.flush();
+				n_failed += result.ok ? 0 : 1;
+			}
+			slots.release();
+		});
+	}
+	pool.wait();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double per_second = seconds > 0 ? paths.size() / seconds : 0.0;
+	std::cerr << "batch inputs=" << paths.size() << " failed=" << n_failed << " threads=" << pool.size()
+			  << " seconds=" << seconds << " inputs_per_second=" << per_second << "\n";
+	return 0 == n_failed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,619 @@
+#pragma once
+
+#include "alloc_counter.h"
+#include "generate.h"
+#include "input.h"
+#include "perf_counters.h"
+#include "thread_pool.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * Benchmark harness shared by every day.
+ *
+ * Each day registers its phases (parse, part_1, part_2, ...) with a Benchmark. Every phase is run
+ * `warmup` times untimed and then `repetitions` times on a monotonic clock, and the samples are
+ * summarised as min / median / p99 / mean / stddev.
+ *
+ * Variants of a phase are named "<phase>/<variant>", e.g. "part_1/quadratic". They run on the
+ * same input, right after the phase they replace, and the report includes their speedup over it.
+ *
+ *     ./build/day.tsk --bench [repetitions] [--warmup n] [--perf] < ./io/input1.txt
+ *
+ * With `--perf` (see parse_phase_args), the timed repetitions are also measured with hardware
+ * counters, and a second table reports them per repetition (cycles, IPC, cache and branch misses).
+ *
+ * Built with -DAOC_COUNT_ALLOCATIONS, the timed repetitions also count allocations, and phases
+ * registered with run_allocation_free are checked: `--alloc-strict` fails the benchmark if any of
+ * them allocates.
+ *
+ * Sweep mode generates its own inputs instead of reading stdin, and writes one CSV row per
+ * (size, threads, phase), ie. a scaling curve:
+ *
+ *     ./build/day.tsk --bench --sweep 1000,10000,100000 [--threads 1,2,4] [--seed s] [--csv out.csv]
+ *
+ * Results can be kept in a baseline file, one entry per (day, phase, size, input bytes, threads), and
+ * later runs compared against it. A phase regressed when its median got slower by more than the noise
+ * threshold and by more than 3 standard errors of the two medians, so that a noisy phase is not
+ * flagged for its noise alone. More allocations per repetition (when counted) are flagged too. Any
+ * regression fails the run, so a CI job can gate on it:
+ *
+ *     ./build/day.tsk --bench --save-baseline ./io/baseline.csv < ./io/input1.txt
+ *     ./build/day.tsk --bench --compare-baseline ./io/baseline.csv [--noise 10] < ./io/input1.txt
+ */
+
+struct BenchOptions {
+	size_t warmup = 3;
+	size_t repetitions = 20;
+
+	std::vector<size_t> sweep_sizes; // empty unless sweeping
+	std::vector<size_t> sweep_threads{0};
+	uint64_t seed = 2025;
+	std::string csv_path; // stdout when empty
+
+	bool strict_allocations = false; // fail if an allocation-free phase allocates
+
+	std::string save_baseline_path;	   // merge the results into this baseline file
+	std::string compare_baseline_path; // compare the results with this baseline file
+	double noise = 0.10;			   // slowdowns below this fraction of the baseline are noise
+};
+
+struct BenchStats {
+	std::string name;
+	size_t repetitions = 0;
+	double min_seconds = 0.0;
+	double median_seconds = 0.0;
+	double p99_seconds = 0.0;
+	double mean_seconds = 0.0;
+	double stddev_seconds = 0.0;
+	PerfSample perf{}; // summed over the timed repetitions, when `--perf` is on
+
+	// summed over the timed repetitions, only with AOC_COUNT_ALLOCATIONS
+	uint64_t allocations = 0;
+	uint64_t allocated_bytes = 0;
+	int64_t peak_live_bytes = 0; // max over the repetitions
+	bool allocation_free = false; // registered with run_allocation_free
+};
+
+// Keep the compiler from optimising away a result that is otherwise unused
+template <typename T>
+inline void do_not_optimize(const T& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+// nearest rank percentile of sorted samples, p in [0, 100]
+inline double percentile_sorted(const std::vector<double>& sorted, const double p) {
+	if (sorted.empty())
+		return 0.0;
+	const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+inline BenchStats summarise(const std::string& name, std::vector<double> samples) {
+	std::sort(samples.begin(), samples.end());
+	const size_t n = samples.size();
+
+	BenchStats stats{.name = name, .repetitions = n};
+	if (0 == n)
+		return stats;
+
+	stats.min_seconds = samples.front();
+	stats.median_seconds = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+	stats.p99_seconds = percentile_sorted(samples, 99.0);
+	stats.mean_seconds = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+
+	double sum_squares = 0.0;
+	for (const double s : samples) {
+		sum_squares += (s - stats.mean_seconds) * (s - stats.mean_seconds);
+	}
+	stats.stddev_seconds = n > 1 ? std::sqrt(sum_squares / (n - 1)) : 0.0;
+	return stats;
+}
+
+class Benchmark {
+public:
+	explicit Benchmark(const BenchOptions& options) : options_{options} {}
+
+	/**
+	 * @brief Time func(state) where state = setup() is rebuilt, untimed, before every run.
+	 *        Use this for phases that mutate their input.
+	 */
+	template <typename FSetup, typename FRun>
+	void run(const std::string& name, FSetup&& setup, FRun&& func) {
+		std::vector<double> samples;
+		samples.reserve(options_.repetitions);
+		PerfSample perf_total;
+		perf_total.valid.fill(true);
+		AllocationCounts allocation_total;
+		for (size_t i = 0; i < options_.warmup + options_.repetitions; ++i) {
+			auto state = setup();
+			const PerfSample perf_start = read_perf_counters();
+			AllocationScope allocation_scope;
+			const auto start = std::chrono::steady_clock::now();
+			do_not_optimize(func(state));
+			const auto end = std::chrono::steady_clock::now();
+			const AllocationCounts allocations = allocation_scope.finish();
+			const PerfSample perf_end = read_perf_counters();
+			if (i >= options_.warmup) {
+				samples.push_back(std::chrono::duration<double>(end - start).count());
+				const PerfSample perf = perf_delta(perf_start, perf_end);
+				for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+					perf_total.valid[e] = perf_total.valid[e] && perf.valid[e];
+					perf_total.values[e] += perf.values[e];
+				}
+				allocation_total.allocations += allocations.allocations;
+				allocation_total.bytes += allocations.bytes;
+				allocation_total.peak_live_bytes =
+					std::max(allocation_total.peak_live_bytes, allocations.peak_live_bytes);
+			}
+		}
+		BenchStats& stats = results_.emplace_back(summarise(name, std::move(samples)));
+		stats.perf = perf_total;
+		stats.allocations = allocation_total.allocations;
+		stats.allocated_bytes = allocation_total.bytes;
+		stats.peak_live_bytes = allocation_total.peak_live_bytes;
+	}
+
+	// time func(), which must return its result so that it cannot be optimised away
+	template <typename FRun>
+	void run(const std::string& name, FRun&& func) {
+		run(name, [] { return 0; }, [&func](int) { return func(); });
+	}
+
+	/**
+	 * @brief Same as run, for a phase that must not allocate once warmed up (the state built by
+	 *        setup is not counted). With `--alloc-strict`, an allocation fails the benchmark.
+	 */
+	template <typename FSetup, typename FRun>
+	void run_allocation_free(const std::string& name, FSetup&& setup, FRun&& func) {
+		run(name, std::forward<FSetup>(setup), std::forward<FRun>(func));
+		BenchStats& stats = results_.back();
+		stats.allocation_free = true;
+		if (ALLOCATION_COUNTING && stats.allocations > 0) {
+			std::cerr << (options_.strict_allocations ? "FAIL" : "WARN") << " allocation-free bench=" << name
+					  << " allocations=" << stats.allocations << " bytes=" << stats.allocated_bytes << "\n";
+			failed_ = failed_ || options_.strict_allocations;
+		}
+	}
+
+	template <typename FRun>
+	void run_allocation_free(const std::string& name, FRun&& func) {
+		run_allocation_free(name, [] { return 0; }, [&func](int) { return func(); });
+	}
+
+	const std::vector<BenchStats>& results() const { return results_; }
+
+	// only in strict mode, when a phase registered as allocation-free allocated
+	bool failed() const { return failed_; }
+
+	void report(std::ostream& os) const {
+		os << std::left << std::setw(28) << "bench" << std::right << std::setw(6) << "reps" << std::setw(14)
+		   << "min_us" << std::setw(14) << "median_us" << std::setw(14) << "p99_us" << std::setw(14)
+		   << "stddev_us" << std::setw(10) << "speedup"
+		   << "\n";
+		for (const BenchStats& stats : results_) {
+			os << std::left << std::setw(28) << stats.name << std::right << std::setw(6) << stats.repetitions
+			   << std::fixed << std::setprecision(2) << std::setw(14) << stats.min_seconds * 1e6
+			   << std::setw(14) << stats.median_seconds * 1e6 << std::setw(14) << stats.p99_seconds * 1e6
+			   << std::setw(14) << stats.stddev_seconds * 1e6;
+
+			const BenchStats* baseline = find_baseline(stats.name);
+			if (baseline && baseline->median_seconds > 0.0 && stats.median_seconds > 0.0) {
+				os << std::setw(9) << baseline->median_seconds / stats.median_seconds << "x";
+			}
+			os << std::defaultfloat << "\n";
+		}
+		report_perf(os);
+		report_allocations(os);
+	}
+
+private:
+	// per repetition means of the hardware counters, only when some were captured
+	void report_perf(std::ostream& os) const {
+		const auto has_perf = [](const BenchStats& stats) {
+			const auto& valid = stats.perf.valid;
+			return std::find(valid.begin(), valid.end(), true) != valid.end();
+		};
+		if (std::none_of(results_.begin(), results_.end(), has_perf))
+			return;
+
+		os << "\n" << std::left << std::setw(28) << "bench" << std::right;
+		for (const std::string_view event : PERF_EVENT_NAMES) {
+			os << std::setw(16) << event;
+		}
+		os << std::setw(8) << "ipc"
+		   << "\n";
+		for (const BenchStats& stats : results_) {
+			const PerfSample& perf = stats.perf;
+			const double reps = std::max<size_t>(1, stats.repetitions);
+			os << std::left << std::setw(28) << stats.name << std::right << std::fixed
+			   << std::setprecision(0);
+			for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+				if (perf.valid[e]) {
+					os << std::setw(16) << perf.values[e] / reps;
+				} else {
+					os << std::setw(16) << "-";
+				}
+			}
+			if (perf.valid[PERF_CYCLES] && perf.valid[PERF_INSTRUCTIONS] && perf.values[PERF_CYCLES]) {
+				os << std::setprecision(2) << std::setw(8)
+				   << static_cast<double>(perf.values[PERF_INSTRUCTIONS]) / perf.values[PERF_CYCLES];
+			}
+			os << std::defaultfloat << "\n";
+		}
+	}
+
+	// per repetition means of the allocations, and the peak of live bytes. '*' marks allocation-free phases
+	void report_allocations(std::ostream& os) const {
+		if (!ALLOCATION_COUNTING)
+			return;
+		os << "\n" << std::left << std::setw(28) << "bench" << std::right << std::setw(14) << "allocs"
+		   << std::setw(16) << "alloc_bytes" << std::setw(16) << "peak_live_bytes"
+		   << "\n";
+		for (const BenchStats& stats : results_) {
+			const double reps = std::max<size_t>(1, stats.repetitions);
+			os << std::left << std::setw(28) << stats.name + (stats.allocation_free ? " *" : "") << std::right
+			   << std::fixed << std::setprecision(1) << std::setw(14) << stats.allocations / reps
+			   << std::setw(16) << stats.allocated_bytes / reps << std::setw(16) << stats.peak_live_bytes
+			   << std::defaultfloat << "\n";
+		}
+	}
+
+	// "part_1/quadratic" is a variant of "part_1"
+	const BenchStats* find_baseline(const std::string& name) const {
+		const size_t slash = name.find('/');
+		if (std::string::npos == slash)
+			return nullptr;
+		const std::string_view phase = std::string_view(name).substr(0, slash);
+		for (const BenchStats& stats : results_) {
+			if (stats.name == phase)
+				return &stats;
+		}
+		return nullptr;
+	}
+
+	BenchOptions options_;
+	std::vector<BenchStats> results_;
+	bool failed_ = false;
+};
+
+constexpr std::string_view BENCH_BASELINE_HEADER = "aoc-bench-baseline 1";
+
+// one phase of one day, on one input, at one thread count
+struct BaselineEntry {
+	std::string id; // the day, e.g. "2025_08"
+	std::string bench;
+	size_t size; // the sweep size, 0 for a real input
+	size_t input_bytes;
+	size_t threads;
+	size_t repetitions;
+	double median_us;
+	double stddev_us;
+	double min_us;
+	double allocations; // per repetition, -1 unless counted
+
+	auto key() const { return std::tie(id, bench, size, input_bytes, threads); }
+};
+
+inline std::vector<BaselineEntry> baseline_entries(
+	const std::string& id,
+	const size_t size,
+	const size_t input_bytes,
+	const size_t threads,
+	const std::vector<BenchStats>& results) {
+	std::vector<BaselineEntry> entries;
+	for (const BenchStats& stats : results) {
+		const double reps = std::max<size_t>(1, stats.repetitions);
+		entries.push_back(BaselineEntry{
+			id,
+			stats.name,
+			size,
+			input_bytes,
+			threads,
+			stats.repetitions,
+			stats.median_seconds * 1e6,
+			stats.stddev_seconds * 1e6,
+			stats.min_seconds * 1e6,
+			ALLOCATION_COUNTING ? stats.allocations / reps : -1.0});
+	}
+	return entries;
+}
+
+// the entries of a baseline file, none if there is no such file
+inline std::vector<BaselineEntry> read_baseline(const std::string& path) {
+	std::vector<BaselineEntry> entries;
+	std::ifstream file(path);
+	if (!file)
+		return entries;
+	std::string line;
+	if (!std::getline(file, line) || BENCH_BASELINE_HEADER != line) {
+		throw std::runtime_error("Not a baseline of this version path=" + path + " header=" + line);
+	}
+	std::getline(file, line); // the column names
+	while (std::getline(file, line)) {
+		std::istringstream fields(line);
+		BaselineEntry entry;
+		char comma;
+		if (!std::getline(fields, entry.id, ',') || !std::getline(fields, entry.bench, ',') ||
+			!(fields >> entry.size >> comma >> entry.input_bytes >> comma >> entry.threads >> comma >>
+			  entry.repetitions >> comma >> entry.median_us >> comma >> entry.stddev_us >> comma >>
+			  entry.min_us >> comma >> entry.allocations)) {
+			throw std::runtime_error("Invalid baseline path=" + path + " line=" + line);
+		}
+		entries.push_back(entry);
+	}
+	return entries;
+}
+
+// written aside and renamed, so that an interrupted run leaves the previous baseline
+inline void write_baseline(const std::string& path, std::vector<BaselineEntry> entries) {
+	std::sort(entries.begin(), entries.end(), [](const BaselineEntry& a, const BaselineEntry& b) {
+		return a.key() < b.key();
+	});
+	const std::string temp = path + ".tmp";
+	{
+		std::ofstream file(temp, std::ios::trunc);
+		file << BENCH_BASELINE_HEADER << "\n"
+			 << "id,bench,size,input_bytes,threads,reps,median_us,stddev_us,min_us,allocs\n";
+		for (const BaselineEntry& entry : entries) {
+			file << entry.id << ',' << entry.bench << ',' << entry.size << ',' << entry.input_bytes << ','
+				 << entry.threads << ',' << entry.repetitions << ',' << entry.median_us << ','
+				 << entry.stddev_us << ',' << entry.min_us << ',' << entry.allocations << '\n';
+		}
+		if (!file) {
+			throw std::runtime_error("Cannot write baseline path=" + temp);
+		}
+	}
+	std::filesystem::rename(temp, path);
+}
+
+// below this, a difference is the clock and the call overhead rather than the phase
+constexpr double BASELINE_MIN_DELTA_US = 1.0;
+
+// slower by more than the noise threshold, and by more than 3 standard errors of the two medians
+inline bool is_slower(const BaselineEntry& baseline, const BaselineEntry& current, const double noise) {
+	const double delta = current.median_us - baseline.median_us;
+	if (delta < BASELINE_MIN_DELTA_US)
+		return false;
+	const double standard_error = std::sqrt(
+		baseline.stddev_us * baseline.stddev_us / std::max<size_t>(1, baseline.repetitions) +
+		current.stddev_us * current.stddev_us / std::max<size_t>(1, current.repetitions));
+	return delta > noise * baseline.median_us && delta > 3 * standard_error;
+}
+
+/**
+ * @brief Compares the current entries with the baseline ones of the same key, and prints a row for each.
+ * @return the number of regressions
+ */
+inline size_t compare_to_baseline(
+	const std::vector<BaselineEntry>& baseline,
+	const std::vector<BaselineEntry>& current,
+	const double noise,
+	std::ostream& os) {
+	os << std::left << std::setw(10) << "day" << std::setw(28) << "bench" << std::right << std::setw(10)
+	   << "size" << std::setw(9) << "threads" << std::setw(14) << "base_us" << std::setw(14) << "now_us"
+	   << std::setw(12) << "change" << "  verdict\n";
+	size_t regressions = 0;
+	for (const BaselineEntry& entry : current) {
+		const auto base = std::find_if(baseline.begin(), baseline.end(), [&entry](const BaselineEntry& b) {
+			return b.key() == entry.key();
+		});
+		os << std::left << std::setw(10) << entry.id << std::setw(28) << entry.bench << std::right
+		   << std::setw(10) << entry.size << std::setw(9) << entry.threads << std::fixed
+		   << std::setprecision(2);
+		if (baseline.end() == base) {
+			os << std::setw(14) << "-" << std::setw(14) << entry.median_us << std::setw(12) << "-"
+			   << "  new" << std::defaultfloat << "\n";
+			continue;
+		}
+
+		const bool slower = is_slower(*base, entry, noise);
+		// allocation counts barely vary between runs, so any growth past the noise is real
+		const bool more_allocations = base->allocations >= 0 && entry.allocations >= 0 &&
+			entry.allocations > base->allocations * (1 + noise) + 0.5;
+		std::string verdict = "ok";
+		if (slower || more_allocations) {
+			verdict = "REGRESSED";
+			verdict += slower ? " time" : "";
+			verdict += more_allocations ? " allocs" : "";
+			++regressions;
+		} else if (is_slower(entry, *base, noise)) {
+			verdict = "faster";
+		}
+		const double change = base->median_us > 0 ? (entry.median_us / base->median_us - 1) * 100 : 0.0;
+		os << std::setw(14) << base->median_us << std::setw(14) << entry.median_us << std::setw(11)
+		   << std::showpos << change << std::noshowpos << "%  " << verdict << std::defaultfloat << "\n";
+	}
+	return regressions;
+}
+
+/**
+ * @brief The baseline steps of one benchmark: compare its results with `--compare-baseline`, then
+ *        merge them into `--save-baseline` (replacing the entries of the same key).
+ * @return whether a phase regressed
+ */
+inline bool apply_baseline(
+	const BenchOptions& options,
+	const std::string& id,
+	const size_t size,
+	const size_t input_bytes,
+	const size_t threads,
+	const std::vector<BenchStats>& results,
+	std::ostream& os) {
+	const std::vector<BaselineEntry> current = baseline_entries(id, size, input_bytes, threads, results);
+	size_t regressions = 0;
+	if (!options.compare_baseline_path.empty()) {
+		os << "\n";
+		const std::vector<BaselineEntry> baseline = read_baseline(options.compare_baseline_path);
+		regressions = compare_to_baseline(baseline, current, options.noise, os);
+	}
+	if (!options.save_baseline_path.empty()) {
+		std::vector<BaselineEntry> entries = read_baseline(options.save_baseline_path);
+		std::erase_if(entries, [&current](const BaselineEntry& entry) {
+			return std::any_of(current.begin(), current.end(), [&entry](const BaselineEntry& c) {
+				return c.key() == entry.key();
+			});
+		});
+		entries.insert(entries.end(), current.begin(), current.end());
+		write_baseline(options.save_baseline_path, std::move(entries));
+	}
+	return regressions > 0;
+}
+
+// "1,10,100" -> {1, 10, 100}
+inline std::vector<size_t> parse_size_list(const std::string_view list) {
+	std::vector<size_t> result;
+	size_t start = 0;
+	while (start < list.size()) {
+		size_t comma = list.find(',', start);
+		if (std::string_view::npos == comma)
+			comma = list.size();
+		result.push_back(std::strtoull(std::string(list.substr(start, comma - start)).c_str(), nullptr, 10));
+		start = comma + 1;
+	}
+	return result;
+}
+
+/**
+ * @brief Parses `--bench [repetitions] [--warmup n] [--alloc-strict]`,
+ *        the sweep options `--sweep sizes [--threads list] [--seed s] [--csv path]`
+ *        and the baseline options `--save-baseline path`, `--compare-baseline path [--noise percent]`.
+ * @return whether benchmarking was requested
+ */
+inline bool parse_bench_args(BenchOptions& options, const int argc, char** argv) {
+	bool requested = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--bench" == arg) {
+			requested = true;
+			if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+				options.repetitions = std::max(1UL, std::strtoul(argv[++i], nullptr, 10));
+			}
+		} else if ("--warmup" == arg && i + 1 < argc) {
+			options.warmup = std::strtoul(argv[++i], nullptr, 10);
+		} else if ("--sweep" == arg && i + 1 < argc) {
+			options.sweep_sizes = parse_size_list(argv[++i]);
+		} else if ("--threads" == arg && i + 1 < argc) {
+			options.sweep_threads = parse_size_list(argv[++i]);
+		} else if ("--seed" == arg && i + 1 < argc) {
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		} else if ("--csv" == arg && i + 1 < argc) {
+			options.csv_path = argv[++i];
+		} else if ("--alloc-strict" == arg) {
+			options.strict_allocations = true;
+		} else if ("--save-baseline" == arg && i + 1 < argc) {
+			options.save_baseline_path = argv[++i];
+		} else if ("--compare-baseline" == arg && i + 1 < argc) {
+			options.compare_baseline_path = argv[++i];
+		} else if ("--noise" == arg && i + 1 < argc) {
+			options.noise = std::strtod(argv[++i], nullptr) / 100;
+		}
+	}
+	return requested;
+}
+
+inline void write_csv_header(std::ostream& os) {
+	os << "size,input_bytes,threads,bench,reps,min_us,median_us,p99_us,mean_us,stddev_us\n";
+}
+
+inline void write_csv_rows(
+	std::ostream& os,
+	const size_t size,
+	const size_t input_bytes,
+	const size_t threads,
+	const std::vector<BenchStats>& results) {
+	for (const BenchStats& stats : results) {
+		os << size << ',' << input_bytes << ',' << threads << ',' << stats.name << ',' << stats.repetitions
+		   << ',' << stats.min_seconds * 1e6 << ',' << stats.median_seconds * 1e6 << ','
+		   << stats.p99_seconds * 1e6 << ',' << stats.mean_seconds * 1e6 << ',' << stats.stddev_seconds * 1e6
+		   << '\n';
+	}
+}
+
+// benchmarks one input of the day id (e.g. "2025_08"), prints the report and applies the baseline options
+template <typename FRegister>
+int run_benchmark_report(
+	const BenchOptions& options,
+	const std::string& id,
+	const Input& input,
+	FRegister&& register_phases,
+	std::ostream& os) {
+	Benchmark bench(options);
+	register_phases(bench, input.lines());
+	bench.report(os);
+	const bool regressed =
+		apply_baseline(options, id, 0, input.text().size(), thread_count(), bench.results(), os);
+	return bench.failed() || regressed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @brief Runs the phases that register_phases(bench, lines) adds, for the day id.
+ *        Without a sweep, the input is read from stdin and a report is printed.
+ *        With a sweep, an input is generated for every size and measured at every thread count.
+ */
+template <typename FRegister, typename FGenerate>
+int run_benchmarks(
+	const BenchOptions& options,
+	const std::string& id,
+	FRegister&& register_phases,
+	FGenerate&& generate) {
+	if (options.strict_allocations && !ALLOCATION_COUNTING) {
+		std::cerr << "--alloc-strict needs a build with -DAOC_COUNT_ALLOCATIONS\n";
+		return EXIT_FAILURE;
+	}
+
+	if (options.sweep_sizes.empty()) {
+		return run_benchmark_report(options, id, Input::from_stdin(), register_phases, std::cout);
+	}
+
+	std::ofstream csv_file;
+	if (!options.csv_path.empty()) {
+		csv_file.open(options.csv_path);
+		if (!csv_file) {
+			std::cerr << "Cannot open csv path=" << options.csv_path << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+	std::ostream& csv = options.csv_path.empty() ? std::cout : csv_file;
+	// the baseline comparison goes wherever the CSV does not
+	std::ostream& report = options.csv_path.empty() ? std::cerr : std::cout;
+	write_csv_header(csv);
+
+	bool failed = false;
+	for (const size_t size : options.sweep_sizes) {
+		const Input input = Input::from_string(generate_to_string(generate, size, options.seed));
+		for (const size_t threads : options.sweep_threads) {
+			set_thread_count(threads);
+			// the pool started at the previous point's size, the rows must measure this one
+			restart_shared_thread_pool();
+			Benchmark bench(options);
+			register_phases(bench, input.lines());
+			write_csv_rows(csv, size, input.text().size(), thread_count(), bench.results());
+			csv.flush();
+			const bool regressed = apply_baseline(
+				options, id, size, input.text().size(), thread_count(), bench.results(), report);
+			failed = failed || bench.failed() || regressed;
+		}
+	}
+	set_thread_count(0);
+	restart_shared_thread_pool();
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "input.h"
+#include "phase.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * A pre-parsed binary form of a day's model, for inputs that are solved again and again: the text is
+ * parsed once (`--compile-model`), and every later run maps the file and uses its arrays in place,
+ * with no per-record parsing at all (`--model`).
+ *
+ *     ./build/day08.tsk --compile-model ./io/08.model < ./io/input1.txt
+ *     ./build/day08.tsk --model ./io/08.model
+ *
+ * Layout, in native byte order (little endian on every machine we run on):
+ *
+ *     BinaryModelHeader                 magic, format version, the day's schema, year & day
+ *     BinarySection x n_sections        offset, count and element size of each array
+ *     padding, array 0, padding, ...    every array starts on a 64 byte boundary
+ *
+ * The schema is the day's own version of its records, to bump whenever they change. A model written
+ * for another day, schema or format version is rejected, as is any section whose element size or
+ * extent does not match.
+ */
+
+constexpr char BINARY_MODEL_MAGIC[8] = {'A', 'O', 'C', 'M', 'O', 'D', 'E', 'L'};
+constexpr uint32_t BINARY_MODEL_VERSION = 1;
+constexpr size_t BINARY_MODEL_ALIGNMENT = 64;
+
+struct BinaryModelHeader {
+	char magic[8];
+	uint32_t version; // of the container, BINARY_MODEL_VERSION
+	uint32_t schema;  // of the day's records
+	uint16_t year;
+	uint16_t day;
+	uint32_t n_sections;
+};
+
+struct BinarySection {
+	uint64_t offset; // from the start of the file
+	uint64_t count;
+	uint32_t element_size;
+	uint32_t reserved;
+};
+
+/**
+ * @brief Collects the arrays of a model and writes them out. The arrays are not copied, so they
+ *        have to outlive write().
+ */
+class BinaryModelWriter {
+public:
+	BinaryModelWriter(const int year, const int day, const uint32_t schema)
+		: header_{{}, BINARY_MODEL_VERSION, schema, uint16_t(year), uint16_t(day), 0} {
+		std::memcpy(header_.magic, BINARY_MODEL_MAGIC, sizeof(header_.magic));
+	}
+
+	template <typename T>
+	void add(const std::span<const T> items) {
+		static_assert(std::is_trivially_copyable_v<T>, "only flat records can be mapped back");
+		static_assert(alignof(T) <= BINARY_MODEL_ALIGNMENT);
+		sections_.push_back(BinarySection{0, items.size(), sizeof(T), 0});
+		data_.emplace_back(reinterpret_cast<const char*>(items.data()), items.size_bytes());
+	}
+
+	template <typename T>
+	void add(const std::vector<T>& items) {
+		add(std::span<const T>(items));
+	}
+
+	void write(std::ostream& os) {
+		header_.n_sections = sections_.size();
+		uint64_t offset = sizeof(BinaryModelHeader) + sections_.size() * sizeof(BinarySection);
+		for (BinarySection& section : sections_) {
+			offset = align(offset);
+			section.offset = offset;
+			offset += section.count * section.element_size;
+		}
+
+		os.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+		os.write(reinterpret_cast<const char*>(sections_.data()), sections_.size() * sizeof(BinarySection));
+		uint64_t written = sizeof(BinaryModelHeader) + sections_.size() * sizeof(BinarySection);
+		const char padding[BINARY_MODEL_ALIGNMENT] = {};
+		for (size_t i = 0; i < sections_.size(); ++i) {
+			os.write(padding, sections_[i].offset - written);
+			os.write(data_[i].data(), data_[i].size());
+			written = sections_[i].offset + data_[i].size();
+		}
+		if (!os) {
+			throw std::runtime_error("Cannot write binary model");
+		}
+	}
+
+private:
+	static uint64_t align(const uint64_t offset) {
+		return (offset + BINARY_MODEL_ALIGNMENT - 1) / BINARY_MODEL_ALIGNMENT * BINARY_MODEL_ALIGNMENT;
+	}
+
+	BinaryModelHeader header_;
+	std::vector<BinarySection> sections_;
+	std::vector<std::string_view> data_;
+};
+
+/**
+ * @brief A model file mapped read-only. Its sections are spans straight into the mapping, valid as
+ *        long as the BinaryModel. Move-only.
+ */
+class BinaryModel {
+public:
+	BinaryModel() = default;
+	BinaryModel(const BinaryModel&) = delete;
+	BinaryModel& operator=(const BinaryModel&) = delete;
+
+	BinaryModel(BinaryModel&& other) noexcept { *this = std::move(other); }
+	BinaryModel& operator=(BinaryModel&& other) noexcept {
+		if (this != &other) {
+			unmap();
+			mapped_ = std::exchange(other.mapped_, nullptr);
+			size_ = std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+	~BinaryModel() { unmap(); }
+
+	// maps path, and checks that it holds a model of this day and schema
+	static BinaryModel map(const std::string& path, const int year, const int day, const uint32_t schema) {
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("Cannot open model path=" + path + " error=" + std::strerror(errno));
+		}
+		struct stat st {};
+		BinaryModel result;
+		if (0 == fstat(fd, &st) && st.st_size > 0) {
+			void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (MAP_FAILED != addr) {
+				result.mapped_ = static_cast<char*>(addr);
+				result.size_ = st.st_size;
+			}
+		}
+		close(fd);
+		if (!result.mapped_) {
+			throw std::runtime_error("Cannot map model path=" + path);
+		}
+
+		if (result.size_ < sizeof(BinaryModelHeader) ||
+			0 != std::memcmp(result.header().magic, BINARY_MODEL_MAGIC, sizeof(BINARY_MODEL_MAGIC))) {
+			throw std::runtime_error("Not a binary model path=" + path);
+		}
+		const BinaryModelHeader& header = result.header();
+		if (BINARY_MODEL_VERSION != header.version || schema != header.schema || year != header.year ||
+			day != header.day) {
+			throw std::runtime_error(
+				"Model mismatch path=" + path + " version=" + std::to_string(header.version) +
+				" schema=" + std::to_string(header.schema) + " day=" + std::to_string(header.year) + "_" +
+				std::to_string(header.day));
+		}
+		if (result.size_ < sizeof(BinaryModelHeader) + header.n_sections * sizeof(BinarySection)) {
+			throw std::runtime_error("Truncated model path=" + path);
+		}
+		return result;
+	}
+
+	size_t n_sections() const { return header().n_sections; }
+
+	template <typename T>
+	std::span<const T> section(const size_t index) const {
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (index >= n_sections()) {
+			throw std::runtime_error("No model section=" + std::to_string(index));
+		}
+		const BinarySection& section = sections()[index];
+		if (sizeof(T) != section.element_size || section.offset % alignof(T) ||
+			section.offset > size_ || section.count > (size_ - section.offset) / sizeof(T)) {
+			throw std::runtime_error("Invalid model section=" + std::to_string(index));
+		}
+		return {reinterpret_cast<const T*>(mapped_ + section.offset), section.count};
+	}
+
+private:
+	const BinaryModelHeader& header() const { return *reinterpret_cast<const BinaryModelHeader*>(mapped_); }
+
+	const BinarySection* sections() const {
+		return reinterpret_cast<const BinarySection*>(mapped_ + sizeof(BinaryModelHeader));
+	}
+
+	void unmap() {
+		if (mapped_) {
+			munmap(mapped_, size_);
+			mapped_ = nullptr;
+			size_ = 0;
+		}
+	}
+
+	char* mapped_ = nullptr;
+	size_t size_ = 0;
+};
+
+struct ModelOptions {
+	std::string compile_path; // --compile-model: parse stdin and write the model here
+	std::string model_path;	  // --model: solve the model mapped from here
+};
+
+/**
+ * @brief Parses `--compile-model <path>` or `--model <path>`.
+ * @return whether either was given
+ */
+inline bool parse_model_args(ModelOptions& options, const int argc, char** argv) {
+	for (int i = 1; i + 1 < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--compile-model" == arg) {
+			options.compile_path = argv[++i];
+		} else if ("--model" == arg) {
+			options.model_path = argv[++i];
+		}
+	}
+	return !options.compile_path.empty() || !options.model_path.empty();
+}
+
+/**
+ * @brief Runs --compile-model or --model for one day. write_model(lines, os) parses the input
+ *        and writes the model, solve_model(path, out) maps it and answers like solve. A model that
+ *        cannot be mapped, or was written for another day or schema, fails the run with its message.
+ */
+template <typename FWrite, typename FSolve>
+int run_model(const ModelOptions& options, FWrite&& write_model, FSolve&& solve_model) {
+	if (!options.compile_path.empty()) {
+		const Input input = time_phase("load", Input::from_stdin);
+		std::ofstream file(options.compile_path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			std::cerr << "Cannot open model path=" << options.compile_path << "\n";
+			return EXIT_FAILURE;
+		}
+		time_phase("compile_model", [&] {
+			write_model(input.lines(), file);
+			return 0;
+		});
+		return EXIT_SUCCESS;
+	}
+
+	// a missing, foreign or truncated model is an error of this run, reported like the one above
+	int status = EXIT_FAILURE;
+	try {
+		status = solve_model(options.model_path, std::cout);
+	} catch (const std::runtime_error& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	print_phase_report();
+	return status;
+}
@@ -0,0 +1,408 @@
+#pragma once
+
+#include "batch.h"
+#include "input.h"
+#include "thread_pool.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Daemon mode: one long-running driver that answers solve requests over a Unix domain socket, so
+ * that small inputs do not pay for process startup, iostream init and cold caches on every request.
+ *
+ * The shared thread pool is started up front, and a fixed set of handler threads serves the
+ * connections, so the threads (and their allocator caches) stay warm from one request to the next.
+ * With `--cache`, the result cache is shared by every request too.
+ *
+ *     ./build/aoc.tsk --serve /tmp/aoc.sock [--handlers 4] [--threads 8] [--cache ~/.cache/aoc]
+ *     ./build/aoc_client.tsk --socket /tmp/aoc.sock 2025 7 < ./io/input1.txt
+ *
+ * Protocol: a connection sends any number of requests, each answered by one JSON line.
+ *
+ *     solve <year> <day> <all|1|2> bytes <n>\n<the n bytes of the input>
+ *     solve <year> <day> <all|1|2> path <path>\n        (a path as seen by the daemon)
+ *     shutdown\n
+ *
+ *     {"status":"ok","year":2025,"day":7,"part":"all","bytes":19283,"load_seconds":1.1e-05,
+ *      "solve_seconds":0.0021,"answers":["Part 1 : number_splits=1562","Part 2 : number_paths=24292"]}
+ *
+ * A request that fails (unknown day, unreadable path, empty input, ...) is answered with
+ * {"status":"error","error":"..."}, and the daemon goes on serving.
+ */
+
+constexpr size_t DAEMON_MAX_HEADER = 4096;
+constexpr size_t DAEMON_MAX_INPUT_BYTES = size_t{1} << 30;
+
+struct DaemonOptions {
+	std::string socket_path;
+	size_t n_handlers = 0; // connections served at once, 0 means thread_count()
+};
+
+/**
+ * @brief Parses `--serve <socket path> [--handlers n]`.
+ * @return whether daemon mode was requested
+ */
+inline bool parse_daemon_args(DaemonOptions& options, const int argc, char** argv) {
+	bool requested = false;
+	for (int i = 1; i + 1 < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--serve" == arg) {
+			requested = true;
+			options.socket_path = argv[++i];
+		} else if ("--handlers" == arg) {
+			options.n_handlers = std::strtoull(argv[++i], nullptr, 10);
+		}
+	}
+	return requested;
+}
+
+struct DaemonRequest {
+	bool shutdown = false;
+	int year = 0;
+	int day = 0;
+	std::string part = "all";
+	std::string path; // empty when the input bytes follow the header
+	size_t n_bytes = 0;
+};
+
+inline std::string daemon_bytes_request(
+	const int year,
+	const int day,
+	const std::string_view part,
+	const size_t n_bytes) {
+	std::ostringstream header;
+	header << "solve " << year << ' ' << day << ' ' << part << " bytes " << n_bytes << '\n';
+	return header.str();
+}
+
+inline std::string daemon_path_request(
+	const int year,
+	const int day,
+	const std::string_view part,
+	const std::string_view path) {
+	std::ostringstream header;
+	header << "solve " << year << ' ' << day << ' ' << part << " path " << path << '\n';
+	return header.str();
+}
+
+inline DaemonRequest parse_daemon_request(const std::string& header) {
+	DaemonRequest request;
+	if ("shutdown" == header) {
+		request.shutdown = true;
+		return request;
+	}
+	std::istringstream fields(header);
+	std::string verb;
+	std::string source;
+	if (!(fields >> verb >> request.year >> request.day >> request.part >> source) || "solve" != verb ||
+		("all" != request.part && "1" != request.part && "2" != request.part)) {
+		throw std::runtime_error("Invalid request header=" + header);
+	}
+	if ("bytes" == source && fields >> request.n_bytes && request.n_bytes <= DAEMON_MAX_INPUT_BYTES) {
+		return request;
+	}
+	if ("path" == source) {
+		std::getline(fields >> std::ws, request.path);
+		if (!request.path.empty())
+			return request;
+	}
+	throw std::runtime_error("Invalid request header=" + header);
+}
+
+// buffered reads of whole lines and exact byte counts from a socket
+class SocketReader {
+public:
+	explicit SocketReader(const int fd) : fd_{fd}, buffer_(1 << 16) {}
+
+	// false at the end of the stream. A line longer than max_size throws
+	bool read_line(std::string& line, const size_t max_size) {
+		line.clear();
+		while (true) {
+			const char* const begin = buffer_.data() + begin_;
+			const char* const end = buffer_.data() + end_;
+			const char* const newline = std::find(begin, end, '\n');
+			line.append(begin, newline);
+			begin_ = newline - buffer_.data();
+			if (newline != end) {
+				++begin_;
+				return true;
+			}
+			if (line.size() > max_size) {
+				throw std::runtime_error("Request header too long");
+			}
+			if (!fill())
+				return false;
+		}
+	}
+
+	// false if the stream ends first
+	bool read_bytes(char* out, size_t n) {
+		while (n > 0) {
+			if (begin_ == end_ && !fill())
+				return false;
+			const size_t n_copied = std::min(n, end_ - begin_);
+			std::memcpy(out, buffer_.data() + begin_, n_copied);
+			begin_ += n_copied;
+			out += n_copied;
+			n -= n_copied;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Appends n bytes to out, false if the stream ends first. out grows a buffer at a time as
+	 *        the bytes arrive, so a request that claims more bytes than it sends only costs what it sent.
+	 */
+	bool read_bytes(std::vector<char>& out, size_t n) {
+		while (n > 0) {
+			const size_t n_chunk = std::min(n, buffer_.size());
+			const size_t offset = out.size();
+			out.resize(offset + n_chunk);
+			if (!read_bytes(out.data() + offset, n_chunk))
+				return false;
+			n -= n_chunk;
+		}
+		return true;
+	}
+
+private:
+	bool fill() {
+		begin_ = end_ = 0;
+		while (true) {
+			const ssize_t n = read(fd_, buffer_.data(), buffer_.size());
+			if (n < 0 && EINTR == errno)
+				continue;
+			if (n <= 0)
+				return false;
+			end_ = n;
+			return true;
+		}
+	}
+
+	int fd_;
+	std::vector<char> buffer_;
+	size_t begin_ = 0;
+	size_t end_ = 0;
+};
+
+// false if the peer went away
+inline bool write_all(const int fd, std::string_view bytes) {
+	while (!bytes.empty()) {
+		const ssize_t n = send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+		if (n < 0 && EINTR == errno)
+			continue;
+		if (n <= 0)
+			return false;
+		bytes.remove_prefix(n);
+	}
+	return true;
+}
+
+inline sockaddr_un daemon_address(const std::string& path) {
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) {
+		throw std::runtime_error("Socket path too long path=" + path);
+	}
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+	return address;
+}
+
+// a connection to the daemon serving path
+inline int connect_daemon(const std::string& path) {
+	const sockaddr_un address = daemon_address(path);
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || 0 != connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address))) {
+		const std::string error = std::strerror(errno);
+		if (fd >= 0)
+			close(fd);
+		throw std::runtime_error("Cannot connect to daemon path=" + path + " error=" + error);
+	}
+	return fd;
+}
+
+// the listening socket. A socket file left by a daemon that died is replaced, a live one is not
+inline int listen_daemon(const std::string& path) {
+	const sockaddr_un address = daemon_address(path);
+	const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+	const bool live =
+		probe >= 0 && 0 == connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+	if (probe >= 0)
+		close(probe);
+	if (live) {
+		throw std::runtime_error("A daemon already serves path=" + path);
+	}
+	unlink(path.c_str());
+
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || 0 != bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ||
+		0 != listen(fd, SOMAXCONN)) {
+		const std::string error = std::strerror(errno);
+		if (fd >= 0)
+			close(fd);
+		throw std::runtime_error("Cannot listen on path=" + path + " error=" + error);
+	}
+	return fd;
+}
+
+/**
+ * @brief Serves requests until a shutdown request. solve(year, day, part, input, out) writes the
+ *        answers of part ("all", "1" or "2") like a day's solve, and throws for a day it does not know.
+ */
+template <typename FSolve>
+int run_daemon(const DaemonOptions& options, FSolve&& solve) {
+	const int listen_fd = listen_daemon(options.socket_path);
+	shared_thread_pool(); // started now rather than by the first request
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<int> accepted;
+	std::set<int> serving;
+	bool stop = false;
+
+	// one request, false once the connection should close
+	const auto answer = [&](SocketReader& reader, const int fd, const std::string& header) {
+		std::ostringstream response;
+		bool in_sync = false; // whether the next request starts where this one ended
+		try {
+			const DaemonRequest request = parse_daemon_request(header);
+			if (request.shutdown) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					stop = true;
+				}
+				shutdown(listen_fd, SHUT_RDWR); // wakes the accept loop
+				write_all(fd, "{\"status\":\"ok\",\"shutdown\":true}\n");
+				return false;
+			}
+
+			const auto load_start = std::chrono::steady_clock::now();
+			Input input;
+			if (request.path.empty()) {
+				std::vector<char> bytes;
+				if (!reader.read_bytes(bytes, request.n_bytes))
+					return false;
+				in_sync = true;
+				input = Input::from_buffer(std::move(bytes));
+			} else {
+				in_sync = true;
+				input = Input::from_file(request.path);
+			}
+			// solvers index their first line, so an empty request would take the whole daemon down
+			if (input.blank()) {
+				throw std::runtime_error("Empty input for day=" + std::to_string(request.day));
+			}
+			const auto solve_start = std::chrono::steady_clock::now();
+			std::ostringstream answers;
+			const int status = solve(request.year, request.day, request.part, input, answers);
+			const auto solve_end = std::chrono::steady_clock::now();
+			const double load_seconds = std::chrono::duration<double>(solve_start - load_start).count();
+			const double solve_seconds = std::chrono::duration<double>(solve_end - solve_start).count();
+
+			response << "{\"status\":\"" << (0 == status ? "ok" : "error") << "\",\"year\":" << request.year
+					 << ",\"day\":" << request.day << ",\"part\":\"" << request.part
+					 << "\",\"bytes\":" << input.text().size() << ",\"load_seconds\":" << load_seconds
+					 << ",\"solve_seconds\":" << solve_seconds << ",\"answers\":";
+			write_json_answers(response, answers.view());
+			response << "}\n";
+		} catch (const std::exception& e) {
+			// the input bytes of a request that could not be parsed cannot be skipped, so that
+			// connection is closed after the error
+			response.str("");
+			response << "{\"status\":\"error\",\"error\":";
+			write_json_string(response, e.what());
+			response << "}\n";
+		}
+		return write_all(fd, response.view()) && in_sync;
+	};
+
+	const auto serve = [&] {
+		while (true) {
+			int fd;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&] { return stop || !accepted.empty(); });
+				if (accepted.empty())
+					return;
+				fd = accepted.front();
+				accepted.pop_front();
+				serving.insert(fd);
+			}
+			SocketReader reader(fd);
+			std::string header;
+			try {
+				while (reader.read_line(header, DAEMON_MAX_HEADER) && answer(reader, fd, header)) {
+				}
+			} catch (const std::exception& e) {
+				std::cerr << "Daemon connection closed error=" << e.what() << "\n";
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				serving.erase(fd);
+			}
+			close(fd);
+		}
+	};
+
+	std::vector<std::thread> handlers;
+	const size_t n_handlers = options.n_handlers ? options.n_handlers : thread_count();
+	for (size_t i = 0; i < n_handlers; ++i) {
+		handlers.emplace_back(serve);
+	}
+	std::cerr << "daemon serving path=" << options.socket_path << " handlers=" << n_handlers
+			  << " threads=" << shared_thread_pool().size() << "\n";
+
+	while (true) {
+		const int fd = accept(listen_fd, nullptr, nullptr);
+		if (fd < 0 && EINTR == errno)
+			continue;
+		std::lock_guard<std::mutex> lock(mutex);
+		if (fd < 0 || stop) {
+			if (fd >= 0)
+				close(fd);
+			break;
+		}
+		accepted.push_back(fd);
+		changed.notify_one();
+	}
+
+	// idle connections are woken up, the requests in progress still send their response
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+		for (const int fd : serving) {
+			shutdown(fd, SHUT_RD);
+		}
+		for (const int fd : accepted) {
+			close(fd);
+		}
+		accepted.clear();
+	}
+	changed.notify_all();
+	for (std::thread& handler : handlers) {
+		handler.join();
+	}
+	close(listen_fd);
+	unlink(options.socket_path.c_str());
+	return EXIT_SUCCESS;
+}
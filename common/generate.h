@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+/**
+ * Synthetic, scalable inputs.
+ *
+ * Every day provides generate_input(os, scale, rng), which writes a valid puzzle input whose size
+ * grows with scale (the number of rotations, ranges, boxes, corners, ...). The same scale and seed
+ * always give the same input, on every platform, since only raw mt19937_64 output is used
+ * (the std distributions are implementation defined).
+ *
+ *     ./build/day.tsk --generate 1000000 [--seed 7] > ./io/big.txt
+ */
+
+struct GenerateOptions {
+	size_t scale = 0;
+	uint64_t seed = 2025;
+};
+
+// uniform-ish integer in [lo, hi]. The modulo bias is irrelevant for test inputs
+inline uint64_t random_between(std::mt19937_64& rng, const uint64_t lo, const uint64_t hi) {
+	return lo + rng() % (hi - lo + 1);
+}
+
+inline bool random_chance(std::mt19937_64& rng, const double p) {
+	return (rng() >> 11) * 0x1.0p-53 < p;
+}
+
+/**
+ * @brief Parses `--generate <scale> [--seed s]`.
+ * @return whether generating was requested
+ */
+inline bool parse_generate_args(GenerateOptions& options, const int argc, char** argv) {
+	bool requested = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--generate" == arg && i + 1 < argc) {
+			requested = true;
+			options.scale = std::strtoull(argv[++i], nullptr, 10);
+		} else if ("--seed" == arg && i + 1 < argc) {
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+	}
+	return requested;
+}
+
+template <typename FGenerate>
+std::string generate_to_string(FGenerate&& generate, const size_t scale, const uint64_t seed) {
+	std::mt19937_64 rng(seed);
+	std::ostringstream os;
+	generate(os, scale, rng);
+	return std::move(os).str();
+}
+
+template <typename FGenerate>
+int run_generator(const GenerateOptions& options, FGenerate&& generate) {
+	std::ios::sync_with_stdio(false);
+	std::mt19937_64 rng(options.seed);
+	generate(std::cout, options.scale, rng);
+	std::cout.flush();
+	return std::cout ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "structural_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The whole puzzle input held in one contiguous buffer, plus a string_view per line.
+ *
+ *        If the source is a regular file (including `./day.tsk < input.txt`), the file is
+ *        memory mapped and nothing is copied. Otherwise (pipes, terminals) it is read into a
+ *        single owned buffer. Lines never own memory, they point into that buffer.
+ *
+ *        Lines are split exactly like getline: on '\n', with no line produced after a trailing
+ *        newline.
+ *
+ *        Move-only, since the lines point into the buffer.
+ */
+class Input {
+public:
+	Input() = default;
+	Input(const Input&) = delete;
+	Input& operator=(const Input&) = delete;
+
+	Input(Input&& other) noexcept { *this = std::move(other); }
+	Input& operator=(Input&& other) noexcept {
+		if (this != &other) {
+			unmap();
+			mapped_ = std::exchange(other.mapped_, nullptr);
+			mapped_size_ = std::exchange(other.mapped_size_, 0);
+			owned_ = std::move(other.owned_);
+			text_ = std::exchange(other.text_, {});
+			lines_ = std::move(other.lines_);
+		}
+		return *this;
+	}
+
+	~Input() { unmap(); }
+
+	static Input from_stdin() { return from_fd(STDIN_FILENO); }
+
+	static Input from_file(const std::string& path) {
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("Cannot open input path=" + path + " error=" + std::strerror(errno));
+		}
+		Input result = from_fd(fd);
+		close(fd);
+		return result;
+	}
+
+	// copies the given text into an owned buffer. Handy for generated inputs.
+	static Input from_string(std::string_view text) {
+		return from_buffer(std::vector<char>(text.begin(), text.end()));
+	}
+
+	// takes over a buffer that was filled elsewhere (a socket, say), without copying it
+	static Input from_buffer(std::vector<char>&& buffer) {
+		Input result;
+		result.owned_ = std::move(buffer);
+		result.text_ = std::string_view(result.owned_.data(), result.owned_.size());
+		result.split_lines();
+		return result;
+	}
+
+	std::string_view text() const { return text_; }
+	const std::vector<std::string_view>& lines() const { return lines_; }
+
+	// nothing but whitespace, which no solver can answer: they all expect at least one line of data
+	bool blank() const {
+		return text_.end() == std::find_if(text_.begin(), text_.end(), [](const char c) {
+				   return !std::isspace(static_cast<unsigned char>(c));
+			   });
+	}
+
+private:
+	static Input from_fd(const int fd) {
+		Input result;
+
+		struct stat st {};
+		if (0 == fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+			void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (MAP_FAILED != addr) {
+				madvise(addr, st.st_size, MADV_SEQUENTIAL);
+				result.mapped_ = static_cast<char*>(addr);
+				result.mapped_size_ = st.st_size;
+				result.text_ = std::string_view(result.mapped_, result.mapped_size_);
+				result.split_lines();
+				return result;
+			}
+		}
+
+		// not mappable. read everything into one buffer, doubling as we go
+		std::vector<char>& buffer = result.owned_;
+		size_t size = 0;
+		buffer.resize(1 << 16);
+		while (true) {
+			if (size == buffer.size()) {
+				buffer.resize(buffer.size() * 2);
+			}
+			const ssize_t n = read(fd, buffer.data() + size, buffer.size() - size);
+			if (n < 0) {
+				if (EINTR == errno)
+					continue;
+				throw std::runtime_error(std::string("Cannot read input error=") + std::strerror(errno));
+			}
+			if (0 == n)
+				break;
+			size += n;
+		}
+		buffer.resize(size);
+
+		result.text_ = std::string_view(buffer.data(), buffer.size());
+		result.split_lines();
+		return result;
+	}
+
+	void split_lines() {
+		const char* const begin = text_.data();
+		size_t line_start = 0;
+		scan_structural(
+			text_,
+			"",
+			[&](const size_t newline) {
+				lines_.emplace_back(begin + line_start, newline - line_start);
+				line_start = newline + 1;
+			},
+			[](size_t) {});
+		if (line_start < text_.size()) {
+			lines_.emplace_back(begin + line_start, text_.size() - line_start);
+		}
+	}
+
+	void unmap() {
+		if (mapped_) {
+			munmap(mapped_, mapped_size_);
+			mapped_ = nullptr;
+			mapped_size_ = 0;
+		}
+	}
+
+	char* mapped_ = nullptr;
+	size_t mapped_size_ = 0;
+	std::vector<char> owned_;
+	std::string_view text_;
+	std::vector<std::string_view> lines_;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "structural_index.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Reads an input chunk by chunk and hands it out as batches of whole lines, for solvers
+ *        that only need the current line (or a small window) and so never need the whole input.
+ *
+ *        A reader thread fills one buffer while the solver works on the other, so reading from a
+ *        pipe overlaps with the computation. Memory is n_buffers * chunk_size whatever the input
+ *        size (a single line longer than a chunk grows its buffer to fit).
+ *
+ *        Lines are split like Input (and getline), and the lines of a batch are contiguous views
+ *        of one buffer, so build_structural_index works on them. They stay valid until the next
+ *        call to next().
+ *
+ *            LineStream stream(STDIN_FILENO);
+ *            vector<string_view> lines;
+ *            while (stream.next(lines)) { ... }
+ */
+class LineStream {
+public:
+	explicit LineStream(const int fd, const size_t chunk_size = 1 << 20, const size_t n_buffers = 2)
+		: fd_{fd}, buffers_(std::max<size_t>(n_buffers, 2)) {
+		for (size_t i = 0; i < buffers_.size(); ++i) {
+			buffers_[i].data.resize(chunk_size);
+			free_.push_back(i);
+		}
+		reader_ = std::thread([this] { read_all(); });
+	}
+
+	LineStream(const LineStream&) = delete;
+	LineStream& operator=(const LineStream&) = delete;
+
+	// if the solver stops early, this waits for the read in progress to return
+	~LineStream() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		changed_.notify_all();
+		reader_.join();
+	}
+
+	/**
+	 * @brief The whole lines of the next chunk.
+	 * @return false once the input is exhausted
+	 */
+	bool next(std::vector<std::string_view>& lines) {
+		lines.clear();
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (in_use_ < buffers_.size()) {
+			free_.push_back(in_use_);
+			in_use_ = buffers_.size();
+			changed_.notify_all();
+		}
+		changed_.wait(lock, [this] { return !ready_.empty() || done_; });
+		if (error_)
+			std::rethrow_exception(error_);
+		if (ready_.empty())
+			return false;
+
+		in_use_ = ready_.front();
+		ready_.pop_front();
+		lock.unlock();
+
+		const Buffer& buffer = buffers_[in_use_];
+		split_lines(std::string_view(buffer.data.data(), buffer.size), lines);
+		return true;
+	}
+
+	// bytes read from the fd so far
+	size_t bytes_read() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return bytes_read_;
+	}
+
+private:
+	struct Buffer {
+		std::vector<char> data;
+		size_t size = 0; // the whole lines at the front of data
+	};
+
+	static void split_lines(const std::string_view text, std::vector<std::string_view>& lines) {
+		size_t line_start = 0;
+		scan_structural(
+			text,
+			"",
+			[&](const size_t newline) {
+				lines.push_back(text.substr(line_start, newline - line_start));
+				line_start = newline + 1;
+			},
+			[](size_t) {});
+		if (line_start < text.size()) {
+			lines.push_back(text.substr(line_start));
+		}
+	}
+
+	void read_all() {
+		try {
+			std::string carry; // the partial last line of the previous chunk
+			bool eof = false;
+			while (!eof) {
+				size_t index;
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					changed_.wait(lock, [this] { return !free_.empty() || stop_; });
+					if (stop_)
+						break;
+					index = free_.front();
+					free_.pop_front();
+				}
+
+				Buffer& buffer = buffers_[index];
+				if (buffer.data.size() <= carry.size()) {
+					buffer.data.resize(2 * carry.size());
+				}
+				std::copy(carry.begin(), carry.end(), buffer.data.begin());
+				size_t size = carry.size();
+				carry.clear();
+
+				// fill the buffer, growing it only if it holds no newline at all
+				size_t last_newline = std::string_view::npos;
+				while (!eof) {
+					if (size == buffer.data.size()) {
+						if (std::string_view::npos != last_newline)
+							break;
+						buffer.data.resize(2 * buffer.data.size());
+					}
+					const ssize_t n = read(fd_, buffer.data.data() + size, buffer.data.size() - size);
+					if (n < 0) {
+						if (EINTR == errno)
+							continue;
+						throw std::runtime_error(std::string("Cannot read input error=") +
+												 std::strerror(errno));
+					}
+					eof = 0 == n;
+					const std::string_view added(buffer.data.data() + size, n);
+					const size_t newline = added.rfind('\n');
+					if (std::string_view::npos != newline)
+						last_newline = size + newline;
+					size += n;
+					std::lock_guard<std::mutex> lock(mutex_);
+					bytes_read_ += n;
+				}
+
+				buffer.size = size;
+				if (!eof && std::string_view::npos != last_newline) {
+					carry.assign(buffer.data.data() + last_newline + 1, size - last_newline - 1);
+					buffer.size = last_newline + 1;
+				}
+				std::lock_guard<std::mutex> lock(mutex_);
+				(0 == buffer.size ? free_ : ready_).push_back(index);
+				changed_.notify_all();
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			error_ = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		done_ = true;
+		changed_.notify_all();
+	}
+
+	int fd_;
+	std::vector<Buffer> buffers_;
+	std::thread reader_;
+
+	mutable std::mutex mutex_;
+	std::condition_variable changed_;
+	std::deque<size_t> free_;  // for the reader to fill
+	std::deque<size_t> ready_; // filled, in input order
+	size_t in_use_ = SIZE_MAX; // the buffer the solver's lines point into
+	size_t bytes_read_ = 0;
+	bool stop_ = false;
+	bool done_ = false;
+	std::exception_ptr error_;
+};
+
+// `--stream` : feed the solver chunk by chunk instead of loading the whole input
+inline bool parse_stream_args(const int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		if (std::string_view("--stream") == argv[i])
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+/**
+ * Compile-time log levels, so that debug dumps (print_grid, print_machine, ...) cost nothing in
+ * the builds that are timed.
+ *
+ * AOC_LOG_LEVEL picks the most verbose level compiled in, LOG_INFO by default. Anything above it
+ * is discarded by `if constexpr`, its formatting included:
+ *
+ *     g++ -std=c++23 -O2 -DAOC_LOG_LEVEL=3 ./2025/09_MovieTheater.cpp    (LOG_DEBUG, with the dumps)
+ *
+ *     log_line<LOG_DEBUG>("last pair x=", x1, ", ", x2);
+ *     log_dump<LOG_DEBUG>([&grid](ostream& os) { print_grid(os, grid, true); });
+ *
+ * Logs go to stderr, one whole line or dump at a time, so stdout only holds the answers and
+ * threads do not interleave.
+ */
+
+enum LogLevel { LOG_OFF = 0, LOG_ERROR = 1, LOG_INFO = 2, LOG_DEBUG = 3 };
+
+#ifndef AOC_LOG_LEVEL
+#define AOC_LOG_LEVEL 2
+#endif
+
+constexpr bool log_enabled(const LogLevel level) {
+	return LOG_OFF != level && level <= AOC_LOG_LEVEL;
+}
+
+inline void write_log(const std::string& text) {
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
+	std::cerr << text;
+}
+
+// one line made of args, only if level is compiled in
+template <LogLevel level, typename... Args>
+inline void log_line(const Args&... args) {
+	if constexpr (log_enabled(level)) {
+		std::ostringstream line;
+		(line << ... << args) << '\n';
+		write_log(line.str());
+	}
+}
+
+// dump(os) writes a multi-line dump, only if level is compiled in
+template <LogLevel level, typename F>
+inline void log_dump(F&& dump) {
+	if constexpr (log_enabled(level)) {
+		std::ostringstream text;
+		dump(text);
+		write_log(text.str());
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "phase.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Parallel building blocks on the shared work-stealing pool, for solvers that run independent
+ * pieces of work at the same time.
+ *
+ * Loops over independent items are split into chunks of at least `grain` items, which the calling
+ * thread and up to thread_count() - 1 pool tasks take in turn. The chunks only depend on n and the
+ * grain, never on the thread count, and parallel_reduce combines their results in chunk order, so a
+ * reduction gives the same result (floating point included) with 1 thread or 64.
+ *
+ *     const u_ll total = parallel_reduce(banks.size(), 64, u_ll{0},
+ *         [&](size_t begin, size_t end) { return sum_max_joltage(banks, begin, end, 12); },
+ *         std::plus<u_ll>{});
+ *
+ * With a single thread (`--threads 1`) every chunk runs in order on the calling thread, and nothing
+ * is allocated.
+ */
+
+/**
+ * @brief Runs independent parts at the same time: the first one on the calling thread, the others
+ *        on the shared pool. The parts may only share immutable data (each keeps its own scratch),
+ *        and their phases nest under the caller's, as if they had run one after the other.
+ *        With a single thread they simply run in order.
+ *
+ *            run_concurrently([&] { result_1 = part_1(model); }, [&] { result_2 = part_2(model); });
+ */
+template <typename FFirst, typename... FRest>
+void run_concurrently(FFirst&& first, FRest&&... rest) {
+	if (1 == thread_count()) {
+		first();
+		(rest(), ...);
+		return;
+	}
+
+	const std::vector<size_t> parent = phase_report().open_phases();
+	TaskGroup group;
+	auto spawn = [&group, &parent](auto& part) {
+		group.run([&parent, &part] {
+			InheritPhases inherit(parent);
+			part();
+		});
+	};
+	(spawn(rest), ...);
+	first();
+	group.wait();
+}
+
+// the most chunks a loop is split into, whatever its size
+constexpr size_t PARALLEL_MAX_CHUNKS = 256;
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// a value alone on its cache line, so that threads writing neighbouring values do not share one
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) Padded {
+	T value;
+};
+
+inline size_t parallel_chunk_count(const size_t n, const size_t grain) {
+	const size_t min_items = std::max<size_t>(grain, 1);
+	return std::min(PARALLEL_MAX_CHUNKS, (n + min_items - 1) / min_items);
+}
+
+/**
+ * @brief Runs chunk(index, begin, end) for every chunk [begin, end) of [0, n), spread over the
+ *        calling thread and the shared pool. Chunks may only write to their own items (or their own
+ *        slot of an array indexed by chunk). The first exception is rethrown once all chunks stopped.
+ */
+template <typename FChunk>
+void parallel_for_chunks(const size_t n, const size_t grain, FChunk&& chunk) {
+	const size_t n_chunks = parallel_chunk_count(n, grain);
+	std::atomic<size_t> next{0};
+	const auto take_chunks = [&] {
+		for (size_t c = next.fetch_add(1, std::memory_order_relaxed); c < n_chunks;
+			 c = next.fetch_add(1, std::memory_order_relaxed)) {
+			chunk(c, c * n / n_chunks, (c + 1) * n / n_chunks);
+		}
+	};
+
+	const size_t n_threads = std::min(thread_count(), n_chunks);
+	if (n_threads <= 1) {
+		take_chunks();
+		return;
+	}
+
+	const std::vector<size_t> parent = phase_report().open_phases();
+	TaskGroup group;
+	for (size_t t = 1; t < n_threads; ++t) {
+		group.run([&parent, &take_chunks] {
+			InheritPhases inherit(parent);
+			take_chunks();
+		});
+	}
+	take_chunks();
+	group.wait();
+}
+
+// func(i) for every i in [0, n)
+template <typename F>
+void parallel_for(const size_t n, const size_t grain, F&& func) {
+	parallel_for_chunks(n, grain, [&func](size_t, const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			func(i);
+		}
+	});
+}
+
+/**
+ * @brief combine(...combine(combine(identity, r_0), r_1)..., r_last), r_c = reduce_chunk(begin, end)
+ *        being the result of chunk c. The partial results are kept one per cache line, and combined
+ *        in chunk order once every chunk is done.
+ */
+template <typename T, typename FReduceChunk, typename FCombine>
+T parallel_reduce(
+	const size_t n,
+	const size_t grain,
+	const T identity,
+	FReduceChunk&& reduce_chunk,
+	FCombine&& combine) {
+	std::array<Padded<T>, PARALLEL_MAX_CHUNKS> partials;
+	const size_t n_chunks = parallel_chunk_count(n, grain);
+	parallel_for_chunks(n, grain, [&](const size_t c, const size_t begin, const size_t end) {
+		partials[c].value = reduce_chunk(begin, end);
+	});
+
+	T result = identity;
+	for (size_t c = 0; c < n_chunks; ++c) {
+		result = combine(std::move(result), std::move(partials[c].value));
+	}
+	return result;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+/**
+ * Allocation-free replacements for stoi / stoull / stoll / stod(string(line.substr(...))).
+ *
+ * They take a string_view straight into the input, so there is no temporary string.
+ * Like the sto* functions, leading spaces are skipped, parsing stops at the first character
+ * that is not part of the number, and invalid / out of range fields throw.
+ *
+ * Runs of 8 digits are converted at once with SWAR (SIMD within a register): the 8 bytes are
+ * loaded into a u64 and combined pairwise in 3 multiplies. The remaining digits go through
+ * from_chars.
+ */
+
+// true when all 8 bytes at p are '0'..'9'
+inline bool is_eight_digits(const char* p) {
+	uint64_t val;
+	std::memcpy(&val, p, sizeof(val));
+	return 0 == (((val & 0xF0F0F0F0F0F0F0F0) | (((val + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ^
+				 0x3333333333333333);
+}
+
+// value of the 8 digits at p. Expects is_eight_digits(p)
+inline uint32_t parse_eight_digits(const char* p) {
+	uint64_t val;
+	std::memcpy(&val, p, sizeof(val));
+	if constexpr (std::endian::native == std::endian::big) {
+		val = __builtin_bswap64(val);
+	}
+	val = (val & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;	  // pairs of digits
+	val = (val & 0x00FF00FF00FF00FF) * 6553601 >> 16; // groups of 4
+	return static_cast<uint32_t>((val & 0x0000FFFF0000FFFF) * 42949672960001 >> 32);
+}
+
+inline std::string_view skip_spaces(std::string_view field) {
+	while (!field.empty() && ' ' == field.front()) {
+		field.remove_prefix(1);
+	}
+	return field;
+}
+
+template <typename T>
+T parse_uint(std::string_view field) {
+	static_assert(std::is_unsigned_v<T>, "parse_uint is for unsigned types");
+	field = skip_spaces(field);
+	const char* p = field.data();
+	const char* const end = p + field.size();
+
+	T value = 0;
+	bool any_digits = false;
+	while (end - p >= 8 && is_eight_digits(p)) {
+		if (__builtin_mul_overflow(value, T{100000000}, &value) ||
+			__builtin_add_overflow(value, parse_eight_digits(p), &value)) {
+			throw std::out_of_range("parse_uint field=" + std::string(field));
+		}
+		p += 8;
+		any_digits = true;
+	}
+
+	T tail = 0;
+	const auto [ptr, ec] = std::from_chars(p, end, tail);
+	if (std::errc::result_out_of_range == ec) {
+		throw std::out_of_range("parse_uint field=" + std::string(field));
+	}
+	if (std::errc{} != ec) {
+		if (!any_digits) {
+			throw std::invalid_argument("parse_uint field=" + std::string(field));
+		}
+		return value;
+	}
+
+	// fold in the tail digits. at most 7 of them when value is non zero
+	T scale = 1;
+	for (const char* q = p; q < ptr; ++q) {
+		if (__builtin_mul_overflow(scale, T{10}, &scale) && 0 != value) {
+			throw std::out_of_range("parse_uint field=" + std::string(field));
+		}
+	}
+	if (__builtin_mul_overflow(value, scale, &value) || __builtin_add_overflow(value, tail, &value)) {
+		throw std::out_of_range("parse_uint field=" + std::string(field));
+	}
+	return value;
+}
+
+template <typename T>
+T parse_int(std::string_view field) {
+	static_assert(std::is_signed_v<T>, "parse_int is for signed types");
+	using U = std::make_unsigned_t<T>;
+	field = skip_spaces(field);
+
+	const bool negative = !field.empty() && '-' == field.front();
+	if (negative) {
+		field.remove_prefix(1);
+	}
+	const U magnitude = parse_uint<U>(field);
+	const U limit = static_cast<U>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+	if (magnitude > limit) {
+		throw std::out_of_range("parse_int field=" + std::string(field));
+	}
+	return negative ? static_cast<T>(U{0} - magnitude) : static_cast<T>(magnitude);
+}
+
+// Integer looking fields (the common case for coordinates) take the integer path, since
+// every integer below 2^53 is exact as a double. Anything else goes through from_chars.
+inline double parse_double(std::string_view field) {
+	field = skip_spaces(field);
+	size_t digits = 0;
+	while (digits < field.size() && '0' <= field[digits] && field[digits] <= '9') {
+		++digits;
+	}
+	const bool integral = digits > 0 && digits <= 15 &&
+						  (digits == field.size() || ('.' != field[digits] && 'e' != field[digits] &&
+													  'E' != field[digits]));
+	if (integral) {
+		return static_cast<double>(parse_uint<uint64_t>(field.substr(0, digits)));
+	}
+
+	double value = 0.0;
+	const auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+	if (std::errc::result_out_of_range == ec) {
+		throw std::out_of_range("parse_double field=" + std::string(field));
+	}
+	if (std::errc{} != ec) {
+		throw std::invalid_argument("parse_double field=" + std::string(field));
+	}
+	return value;
+}
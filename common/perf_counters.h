@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Hardware performance counters, opt-in with `--perf`.
+ *
+ * Every thread that measures gets its own set of counters (cycles, instructions, L1D and LLC
+ * misses, branch misses), opened once with perf_event_open and then only read around a phase.
+ * User space only, so it works with perf_event_paranoid <= 2.
+ *
+ * When the kernel refuses (containers, paranoid = 3, no PMU in a VM, not Linux), a single warning
+ * is printed and the run carries on with wall time only. Events the CPU does not have are skipped
+ * one by one, so a VM without LLC events still gets cycles and instructions.
+ */
+
+enum PerfEvent : size_t {
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_L1D_MISSES,
+	PERF_LLC_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_EVENT_COUNT
+};
+
+constexpr std::array<std::string_view, PERF_EVENT_COUNT> PERF_EVENT_NAMES{
+	"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+struct PerfSample {
+	std::array<uint64_t, PERF_EVENT_COUNT> values{};
+	std::array<bool, PERF_EVENT_COUNT> valid{};
+};
+
+inline bool& perf_counters_setting() {
+	static bool setting = false;
+	return setting;
+}
+
+inline void set_perf_counters_enabled(const bool enabled) { perf_counters_setting() = enabled; }
+
+inline bool perf_counters_enabled() { return perf_counters_setting(); }
+
+class PerfCounters {
+public:
+	PerfCounters() {
+		fds_.fill(-1);
+#ifdef __linux__
+		// {type, config} per PerfEvent, in order
+		constexpr uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+										   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		constexpr std::array<std::pair<uint32_t, uint64_t>, PERF_EVENT_COUNT> events{{
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+			{PERF_TYPE_HW_CACHE, L1D_READ_MISS},
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+		}};
+
+		int last_error = 0;
+		for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = events[i].first;
+			attr.config = events[i].second;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			// when more events are open than the PMU has counters, the kernel multiplexes them
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+			// this thread, any cpu
+			fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+			if (fds_[i] < 0) {
+				last_error = errno;
+			} else {
+				available_ = true;
+			}
+		}
+		if (!available_) {
+			warn_unavailable(last_error);
+		}
+#else
+		warn_unavailable(0);
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	~PerfCounters() {
+#ifdef __linux__
+		for (const int fd : fds_) {
+			if (fd >= 0)
+				close(fd);
+		}
+#endif
+	}
+
+	bool available() const { return available_; }
+
+	// counters are free running, so a phase is the difference of two samples
+	PerfSample read() const {
+		PerfSample sample;
+#ifdef __linux__
+		for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+			uint64_t buffer[3]; // value, time enabled, time running
+			if (fds_[i] < 0 || sizeof(buffer) != ::read(fds_[i], buffer, sizeof(buffer)))
+				continue;
+			// scale up if the event was multiplexed for part of the time
+			const bool multiplexed = buffer[2] && buffer[2] < buffer[1];
+			sample.values[i] =
+				multiplexed ? static_cast<uint64_t>(1.0 * buffer[0] * buffer[1] / buffer[2]) : buffer[0];
+			sample.valid[i] = true;
+		}
+#endif
+		return sample;
+	}
+
+private:
+	static void warn_unavailable(const int error) {
+		static bool warned = false;
+		if (warned)
+			return;
+		warned = true;
+		std::cerr << "perf counters unavailable, reporting wall time only";
+		if (error)
+			std::cerr << " error=" << std::strerror(error) << " (see /proc/sys/kernel/perf_event_paranoid)";
+		std::cerr << "\n";
+	}
+
+	std::array<int, PERF_EVENT_COUNT> fds_;
+	bool available_ = false;
+};
+
+// opened lazily, once per thread
+inline const PerfCounters& thread_perf_counters() {
+	thread_local const PerfCounters counters;
+	return counters;
+}
+
+// the counters of this thread, or an empty sample when `--perf` is off or the kernel refused
+inline PerfSample read_perf_counters() {
+	if (!perf_counters_enabled())
+		return {};
+	return thread_perf_counters().read();
+}
+
+// end - start for the events that were valid at both ends
+inline PerfSample perf_delta(const PerfSample& start, const PerfSample& end) {
+	PerfSample delta;
+	for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+		delta.valid[i] = start.valid[i] && end.valid[i];
+		delta.values[i] = delta.valid[i] ? end.values[i] - start.values[i] : 0;
+	}
+	return delta;
+}
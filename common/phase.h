@@ -0,0 +1,290 @@
+#pragma once
+
+#include "alloc_counter.h"
+#include "perf_counters.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Phase level instrumentation, replacing the per-file time_wrap.
+ *
+ * A ScopedPhase times its scope on a monotonic clock. Phases nest, and are recorded by their
+ * path, e.g. "part_2/compress". Entering the same path again (a loop, or benchmark repetitions)
+ * accumulates into the same record, so the report stays one entry per phase.
+ *
+ * Phases nest per thread, so tasks on a thread pool can open their own phases.
+ * Counters ("states_expanded", "heap_pushes", ...) are attributed to the innermost open phase.
+ * Keep hot loops free of instrumentation: count into a local and call add_counter once.
+ *
+ * With `--perf`, every phase also accumulates the hardware counters of perf_counters.h
+ * (cycles, instructions, ...) as counters of its record.
+ *
+ * Built with -DAOC_COUNT_ALLOCATIONS, every phase also counts the allocations and bytes of its
+ * thread, and its peak of live bytes (see alloc_counter.h). The report always ends with the peak RSS.
+ *
+ * With `--trace <path>`, every phase is also an event of the timeline of trace.h.
+ *
+ * The whole run is written as one JSON object on a single line:
+ *     {"phases":[{"name":"part_1","calls":1,"seconds":0.0012,"counters":{"heap_pushes":499500}}, ...],
+ *      "peak_rss_kb":4096}
+ */
+
+struct PhaseRecord {
+	std::string path;
+	size_t depth;
+	uint64_t calls;
+	double seconds;
+	std::vector<std::pair<std::string, uint64_t>> counters;
+	int64_t peak_live_bytes; // the max over its calls, only with AOC_COUNT_ALLOCATIONS
+};
+
+class PhaseReport {
+public:
+	// returns the index of the record for the phase that was opened
+	size_t begin(const std::string_view name) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::string path(name);
+		if (!open().empty()) {
+			path = records_[open().back()].path + "/" + path;
+		}
+		size_t index = find(path);
+		if (records_.size() == index) {
+			records_.push_back(PhaseRecord{std::move(path), open().size(), 0, 0.0, {}, 0});
+		}
+		open().push_back(index);
+		return index;
+	}
+
+	void end(
+		const size_t index,
+		const double seconds,
+		const PerfSample& perf = {},
+		const AllocationCounts& allocations = {}) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		PhaseRecord& record = records_[index];
+		++record.calls;
+		record.seconds += seconds;
+		add_usage(record, perf, allocations);
+		if (!open().empty() && open().back() == index) {
+			open().pop_back();
+		}
+	}
+
+	// what another thread did for an open phase (see InheritPhases), without counting a call
+	void add_worker_usage(const size_t index, const PerfSample& perf, const AllocationCounts& allocations) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		add_usage(records_[index], perf, allocations);
+	}
+
+	// counters outside of any phase go to a "run" record
+	void add_counter(const std::string_view name, const uint64_t delta) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		size_t index = open().empty() ? find("run") : open().back();
+		if (records_.size() == index) {
+			records_.push_back(PhaseRecord{"run", 0, 0, 0.0, {}, 0});
+		}
+		add_to_record(records_[index], name, delta);
+	}
+
+	// the phases open on the calling thread, for the tasks it spawns (see InheritPhases)
+	std::vector<size_t> open_phases() const { return open(); }
+
+	// replaces the phases open on the calling thread, and hands back the previous ones
+	std::vector<size_t> swap_open_phases(std::vector<size_t> phases) {
+		std::swap(open(), phases);
+		return phases;
+	}
+
+	std::string path(const size_t index) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return records_[index].path;
+	}
+
+	std::vector<PhaseRecord> records() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return records_;
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		records_.clear();
+		open().clear();
+	}
+
+	void write_json(std::ostream& os) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		os << "{\"phases\":[";
+		for (size_t i = 0; i < records_.size(); ++i) {
+			const PhaseRecord& record = records_[i];
+			os << (i ? "," : "") << "{\"name\":\"" << record.path << "\",\"depth\":" << record.depth
+			   << ",\"calls\":" << record.calls << ",\"seconds\":" << record.seconds << ",\"counters\":{";
+			for (size_t j = 0; j < record.counters.size(); ++j) {
+				os << (j ? "," : "") << '"' << record.counters[j].first << "\":" << record.counters[j].second;
+			}
+			os << "}";
+			if (ALLOCATION_COUNTING) {
+				os << ",\"peak_live_bytes\":" << record.peak_live_bytes;
+			}
+			os << "}";
+		}
+		os << "],\"peak_rss_kb\":" << peak_rss_kb() << "}\n";
+	}
+
+private:
+	static void add_usage(PhaseRecord& record, const PerfSample& perf, const AllocationCounts& allocations) {
+		for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+			if (perf.valid[i]) {
+				add_to_record(record, PERF_EVENT_NAMES[i], perf.values[i]);
+			}
+		}
+		if (ALLOCATION_COUNTING) {
+			add_to_record(record, "allocations", allocations.allocations);
+			add_to_record(record, "allocated_bytes", allocations.bytes);
+			record.peak_live_bytes = std::max(record.peak_live_bytes, allocations.peak_live_bytes);
+		}
+	}
+
+	static void add_to_record(PhaseRecord& record, const std::string_view name, const uint64_t delta) {
+		for (auto& [counter_name, value] : record.counters) {
+			if (counter_name == name) {
+				value += delta;
+				return;
+			}
+		}
+		record.counters.emplace_back(std::string(name), delta);
+	}
+
+	size_t find(const std::string_view path) const {
+		for (size_t i = 0; i < records_.size(); ++i) {
+			if (records_[i].path == path)
+				return i;
+		}
+		return records_.size();
+	}
+
+	// the phases open on the calling thread, innermost last
+	static std::vector<size_t>& open() {
+		thread_local std::vector<size_t> open;
+		return open;
+	}
+
+	mutable std::mutex mutex_;
+	std::vector<PhaseRecord> records_;
+};
+
+inline PhaseReport& phase_report() {
+	static PhaseReport report;
+	return report;
+}
+
+inline void add_counter(const std::string_view name, const uint64_t delta = 1) {
+	phase_report().add_counter(name, delta);
+}
+
+class ScopedPhase {
+public:
+	explicit ScopedPhase(const std::string_view name)
+		: index_{phase_report().begin(name)}, perf_start_{read_perf_counters()},
+		  trace_start_us_{tracing_enabled() ? trace_recorder().now_us() : 0.0},
+		  start_{std::chrono::steady_clock::now()} {}
+
+	ScopedPhase(const ScopedPhase&) = delete;
+	ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+	~ScopedPhase() {
+		const auto end = std::chrono::steady_clock::now();
+		const PerfSample perf_end = read_perf_counters();
+		const AllocationCounts allocations = allocations_.finish();
+		const double seconds = std::chrono::duration<double>(end - start_).count();
+		phase_report().end(index_, seconds, perf_delta(perf_start_, perf_end), allocations);
+
+		if (tracing_enabled()) {
+			TraceRecorder& recorder = trace_recorder();
+			const double end_us = recorder.now_us();
+			const double duration_us = end_us - trace_start_us_;
+			const std::string path = phase_report().path(index_);
+			recorder.record(TraceEvent{path, "phase", trace_thread_id(), -1, trace_start_us_, duration_us});
+		}
+	}
+
+private:
+	size_t index_;
+	PerfSample perf_start_;
+	double trace_start_us_;
+	AllocationScope allocations_; // after the report's own bookkeeping, so it is not counted
+	std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Opens the phases of another thread on this one for its scope, so that the phases of a task
+ *        nest under the phase that spawned it rather than starting a new root. The counters are per
+ *        thread, so the hardware counters and allocations of the scope are also added to the
+ *        innermost inherited phase: a phase counts the work of its tasks, whichever thread ran them.
+ *
+ *            const vector<size_t> parent = phase_report().open_phases();
+ *            pool.submit([&parent] { InheritPhases inherit(parent); ScopedPhase phase("part_2"); ... });
+ */
+class InheritPhases {
+public:
+	explicit InheritPhases(std::vector<size_t> phases)
+		: target_{phases.empty() ? NO_PHASE : phases.back()},
+		  saved_{phase_report().swap_open_phases(std::move(phases))}, perf_start_{read_perf_counters()} {}
+
+	InheritPhases(const InheritPhases&) = delete;
+	InheritPhases& operator=(const InheritPhases&) = delete;
+
+	~InheritPhases() {
+		const PerfSample perf_end = read_perf_counters();
+		const AllocationCounts allocations = allocations_.finish();
+		if (NO_PHASE != target_) {
+			phase_report().add_worker_usage(target_, perf_delta(perf_start_, perf_end), allocations);
+		}
+		phase_report().swap_open_phases(std::move(saved_));
+	}
+
+private:
+	static constexpr size_t NO_PHASE = SIZE_MAX;
+
+	size_t target_;
+	std::vector<size_t> saved_;
+	PerfSample perf_start_;
+	AllocationScope allocations_;
+};
+
+// run func inside a phase and hand back its result
+template <typename F>
+auto time_phase(const std::string_view name, F&& func) {
+	ScopedPhase phase(name);
+	return func();
+}
+
+// prints the report, and writes the timeline when tracing
+inline void print_phase_report(std::ostream& os = std::cout) {
+	phase_report().write_json(os);
+	trace_recorder().write();
+}
+
+/**
+ * @brief Parses the instrumentation options shared by every day:
+ *        `--perf` also captures hardware counters per phase,
+ *        `--trace <path>` writes a Chrome trace of the phases and tasks.
+ */
+inline void parse_phase_args(const int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--perf" == arg) {
+			set_perf_counters_enabled(true);
+		} else if ("--trace" == arg && i + 1 < argc) {
+			trace_recorder().enable(argv[++i]);
+		}
+	}
+}
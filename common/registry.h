@@ -0,0 +1,181 @@
+#pragma once
+
+#include "bench.h"
+#include "binary_model.h"
+#include "generate.h"
+#include "input.h"
+#include "line_stream.h"
+#include "phase.h"
+#include "result_cache.h"
+#include "threads.h"
+#include "verify.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Every solver registers its entry points here, so that one driver (aoc.cpp) can run any day,
+ * a list of days or all of them in a single process.
+ *
+ *     const RegisterSolver registered{{2025, 7, "Laboratory", solve, benchmark, generate_input}};
+ *
+ * solve runs the parse / part_1 / part_2 phases and writes the answers to `out`, benchmark
+ * registers the same phases one by one, and generate_input writes a synthetic input. Solvers that
+ * only need one line at a time also register solve_stream, which answers both parts in one pass
+ * over a LineStream, and the days with a binary model register write_model / solve_model. The days
+ * whose fast paths have a reference implementation register verify (`--verify`, see verify.h).
+ *
+ * Built on its own, a day's main() is run_day_main, which offers whichever of these it registered:
+ *
+ *     int main(int argc, char** argv) { return run_day_main(registered, argc, argv); }
+ */
+
+struct Solver {
+	int year;
+	int day;
+	std::string_view title;
+	int (*solve)(const std::vector<std::string_view>& input_lines, std::ostream& out);
+	void (*benchmark)(Benchmark& bench, const std::vector<std::string_view>& input_lines);
+	void (*generate_input)(std::ostream& os, size_t scale, std::mt19937_64& rng);
+
+	// only for the line-local solvers, which can run on a LineStream (`--stream`)
+	int (*solve_stream)(LineStream& stream, std::ostream& out) = nullptr;
+
+	// only for the days with a binary model (`--compile-model` / `--model`, see binary_model.h)
+	void (*write_model)(const std::vector<std::string_view>& input_lines, std::ostream& os) = nullptr;
+	int (*solve_model)(const std::string& path, std::ostream& out) = nullptr;
+
+	// only for the days with reference / optimized pairs to check (`--verify`)
+	void (*verify)(Verifier& verifier, const std::vector<std::string_view>& input_lines) = nullptr;
+};
+
+class SolverRegistry {
+public:
+	void add(const Solver& solver) {
+		solvers_.push_back(solver);
+		std::sort(solvers_.begin(), solvers_.end(), [](const Solver& a, const Solver& b) {
+			return a.year != b.year ? a.year < b.year : a.day < b.day;
+		});
+	}
+
+	// nullptr if there is no such solver
+	const Solver* find(const int year, const int day) const {
+		for (const Solver& solver : solvers_) {
+			if (solver.year == year && solver.day == day)
+				return &solver;
+		}
+		return nullptr;
+	}
+
+	// sorted by year, then day
+	const std::vector<Solver>& all() const { return solvers_; }
+
+private:
+	std::vector<Solver> solvers_;
+};
+
+inline SolverRegistry& solver_registry() {
+	static SolverRegistry registry;
+	return registry;
+}
+
+// "2025_07", the name of the day in phases and benchmark baselines
+inline std::string solver_id(const Solver& solver) {
+	char id[16];
+	std::snprintf(id, sizeof(id), "%d_%02d", solver.year, solver.day);
+	return id;
+}
+
+// `--bench` for one day, see bench.h
+inline int run_benchmarks(const BenchOptions& options, const Solver& solver) {
+	return run_benchmarks(options, solver_id(solver), solver.benchmark, solver.generate_input);
+}
+
+// the cached answers of one day, see result_cache.h
+inline int solve_cached(
+	const Solver& solver, const Input& input, std::ostream& out, const std::string_view part = "all") {
+	return solve_cached(solver.year, solver.day, solver.solve, input, out, part);
+}
+
+// also keeps its solver, for the day's own main()
+struct RegisterSolver {
+	explicit RegisterSolver(const Solver& solver_) : solver{solver_} { solver_registry().add(solver); }
+	const Solver solver;
+};
+
+/**
+ * @brief A day built on its own: `--generate`, `--bench`, then `--verify`, `--compile-model` / `--model`
+ *        and `--stream` when the day registered them, and otherwise a solve of stdin.
+ */
+inline int run_day(const RegisterSolver& registered, const int argc, char** argv) {
+	const Solver& solver = registered.solver;
+	parse_phase_args(argc, argv);
+	parse_thread_args(argc, argv);
+	parse_cache_args(argc, argv);
+
+	GenerateOptions generate_options;
+	if (parse_generate_args(generate_options, argc, argv)) {
+		return run_generator(generate_options, solver.generate_input);
+	}
+
+	BenchOptions bench_options;
+	if (parse_bench_args(bench_options, argc, argv)) {
+		return run_benchmarks(bench_options, solver);
+	}
+
+	VerifyOptions verify_options;
+	if (parse_verify_args(verify_options, argc, argv)) {
+		if (!solver.verify) {
+			std::cerr << "--verify : day " << solver.day << " has no reference to check against\n";
+			return EXIT_FAILURE;
+		}
+		return run_verification(verify_options, solver.verify, solver.generate_input);
+	}
+
+	ModelOptions model_options;
+	if (parse_model_args(model_options, argc, argv)) {
+		if (!solver.write_model) {
+			std::cerr << "--compile-model / --model : day " << solver.day << " has no binary model\n";
+			return EXIT_FAILURE;
+		}
+		return run_model(model_options, solver.write_model, solver.solve_model);
+	}
+
+	if (parse_stream_args(argc, argv)) {
+		if (!solver.solve_stream) {
+			std::cerr << "Day " << solver.day << " cannot run on a stream\n";
+			return EXIT_FAILURE;
+		}
+		LineStream stream(STDIN_FILENO);
+		if (0 != solver.solve_stream(stream, std::cout)) {
+			return EXIT_FAILURE;
+		}
+		print_phase_report();
+		return EXIT_SUCCESS;
+	}
+
+	const Input input = time_phase("load", Input::from_stdin);
+	if (0 != solve_cached(solver, input, std::cout)) {
+		return EXIT_FAILURE;
+	}
+	print_phase_report();
+	return EXIT_SUCCESS;
+}
+
+// the main() of a day built on its own; like the driver, errors end the run with their message rather than an abort
+inline int run_day_main(const RegisterSolver& registered, const int argc, char** argv) {
+	try {
+		return run_day(registered, argc, argv);
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+}
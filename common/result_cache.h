@@ -0,0 +1,455 @@
+#pragma once
+
+#include "input.h"
+#include "phase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * A content-addressed, on-disk cache of results, for pipelines that keep resubmitting the same inputs.
+ *
+ * Off unless a directory is given with `--cache <dir>` (or AOC_CACHE_DIR). `--no-cache` turns it off
+ * again, and benchmarks never use it, so timings always measure the solver.
+ *
+ *     ./build/aoc.tsk 2025 all --input-dir ./io/2025 --cache ~/.cache/aoc [--cache-max-mb 256]
+ *
+ * Whole answers: solve_cached looks up hash(year, day, part, input bytes) before running solve, and stores
+ * what solve wrote on a miss, one file per entry.
+ * Finer results: a ResultMemo is a key -> int64 table in one append-only file, e.g. day 10 keeps the
+ * part 2 presses of every machine it has seen.
+ *
+ * Keys are salted with RESULT_CACHE_VERSION, not the build, so a rebuild keeps the cache: bump it whenever
+ * a change to a solver can change its answers, and every older entry is ignored. Above the size limit, the least recently used entries are evicted down to 3/4 of it. Memos are not entries,
+ * each one keeps itself under a quarter of the limit instead. Any I/O error is a miss: the cache never
+ * fails a solve.
+ */
+
+/**
+ * @brief MurmurHash64A, 8 bytes at a time. Fast, and plenty for content addressing, the entries
+ *        also record the input size to catch the odd collision.
+ */
+inline uint64_t hash_bytes(const std::string_view bytes, const uint64_t seed = 0) {
+	constexpr uint64_t m = 0xc6a4a7935bd1e995ULL;
+	constexpr int r = 47;
+	const size_t n = bytes.size();
+	uint64_t h = seed ^ (n * m);
+
+	const char* data = bytes.data();
+	const char* const end = data + (n & ~size_t{7});
+	for (; data != end; data += 8) {
+		uint64_t k;
+		std::memcpy(&k, data, 8);
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+	const size_t tail = n & 7;
+	if (tail) {
+		uint64_t k = 0;
+		std::memcpy(&k, data, tail);
+		h ^= k;
+		h *= m;
+	}
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+	return h;
+}
+
+// of the cached results, bump when a solver's answers (or a memo's values) change
+constexpr uint32_t RESULT_CACHE_VERSION = 1;
+
+// entries written with any other RESULT_CACHE_VERSION are ignored
+inline uint64_t cache_version_salt() {
+	static const uint64_t salt = hash_bytes("aoc result cache v" + std::to_string(RESULT_CACHE_VERSION));
+	return salt;
+}
+
+inline uint64_t cache_key(
+	const int year, const int day, const std::string_view part, const std::string_view bytes) {
+	const uint64_t key = hash_bytes(part, cache_version_salt() ^ (uint64_t(year) << 8 | uint64_t(day)));
+	return hash_bytes(bytes, key);
+}
+
+class ResultCache {
+public:
+	bool enabled() const { return !dir_.empty(); }
+	const std::filesystem::path& dir() const { return dir_; }
+	uintmax_t max_bytes() const { return max_bytes_; }
+
+	void configure(const std::string& dir, const uintmax_t max_bytes) {
+		dir_ = dir;
+		max_bytes_ = max_bytes;
+		if (!dir_.empty()) {
+			std::error_code error;
+			std::filesystem::create_directories(dir_, error);
+			if (error) {
+				std::cerr << "Cache disabled, cannot create dir=" << dir_.string()
+						  << " error=" << error.message() << "\n";
+				dir_.clear();
+			}
+		}
+	}
+
+	// the answers stored under key, if any
+	std::optional<std::string> find(const uint64_t key, const size_t input_bytes) const {
+		if (!enabled())
+			return std::nullopt;
+		const std::filesystem::path path = entry_path(key);
+		std::ifstream file(path, std::ios::binary);
+		std::string header;
+		if (!file || !std::getline(file, header) || header != entry_header(key, input_bytes))
+			return std::nullopt;
+		std::ostringstream answers;
+		answers << file.rdbuf();
+
+		// hits count as uses, for the eviction
+		std::error_code error;
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+		return std::move(answers).str();
+	}
+
+	void insert(const uint64_t key, const size_t input_bytes, const std::string_view answers) {
+		if (!enabled())
+			return;
+		// written aside and renamed, so that concurrent readers only ever see whole entries
+		const std::filesystem::path path = entry_path(key);
+		std::filesystem::path temp = path;
+		temp += ".tmp" + std::to_string(temp_counter_.fetch_add(1));
+		{
+			std::ofstream file(temp, std::ios::binary);
+			file << entry_header(key, input_bytes) << '\n' << answers;
+			if (!file)
+				return;
+		}
+		// the entry this one replaces, if any, leaves the running total
+		std::error_code error;
+		const uintmax_t replaced = std::filesystem::file_size(path, error);
+		const uintmax_t replaced_bytes = error ? 0 : replaced;
+		std::filesystem::rename(temp, path, error);
+		if (error) {
+			std::filesystem::remove(temp, error);
+			return;
+		}
+		const uintmax_t size = std::filesystem::file_size(path, error);
+		const uintmax_t added_bytes = error ? 0 : size;
+
+		// the directory is only scanned once per process, and again when the total outgrows max_bytes
+		std::lock_guard<std::mutex> lock(evict_mutex_);
+		if (total_bytes_) {
+			*total_bytes_ = *total_bytes_ - std::min(replaced_bytes, *total_bytes_) + added_bytes;
+		}
+		if (!total_bytes_ || *total_bytes_ > max_bytes_) {
+			evict();
+		}
+	}
+
+private:
+	/**
+	 * @brief Scans the directory for the true total of the entries, other processes' included. Above
+	 *        max_bytes, drops the least recently used entries down to 3/4 of it, so that the next scan
+	 *        is many inserts away. Called with evict_mutex_ held.
+	 */
+	void evict() {
+		namespace fs = std::filesystem;
+		std::error_code error;
+		std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+		uintmax_t total = 0;
+		for (const fs::directory_entry& entry : fs::directory_iterator(dir_, error)) {
+			// only answer entries: the memos compact themselves, and temp files are still being written
+			if (!entry.is_regular_file(error) || ".txt" != entry.path().extension())
+				continue;
+			const uintmax_t size = entry.file_size(error);
+			if (error)
+				continue;
+			total += size;
+			entries.emplace_back(entry.last_write_time(error), entry.path());
+		}
+		total_bytes_ = total;
+		if (total <= max_bytes_)
+			return;
+
+		const uintmax_t low_water = max_bytes_ - max_bytes_ / 4;
+		std::sort(entries.begin(), entries.end());
+		for (const auto& [time, path] : entries) {
+			if (total <= low_water)
+				break;
+			const uintmax_t size = fs::file_size(path, error);
+			if (!error && fs::remove(path, error))
+				total -= size;
+		}
+		total_bytes_ = total;
+	}
+
+private:
+	std::filesystem::path entry_path(const uint64_t key) const {
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.txt", static_cast<unsigned long long>(key));
+		return dir_ / name;
+	}
+
+	static std::string entry_header(const uint64_t key, const size_t input_bytes) {
+		char header[64];
+		const unsigned long long key_bits = key;
+		std::snprintf(header, sizeof(header), "aoc-result-cache 1 %016llx %zu", key_bits, input_bytes);
+		return header;
+	}
+
+	std::filesystem::path dir_;
+	uintmax_t max_bytes_ = uintmax_t{256} << 20;
+	std::atomic<uint64_t> temp_counter_{0};
+	std::mutex evict_mutex_;
+	std::optional<uintmax_t> total_bytes_; // of the entries, unknown until the first scan
+};
+
+inline ResultCache& result_cache() {
+	static ResultCache cache;
+	return cache;
+}
+
+/**
+ * @brief Parses `--cache <dir> [--cache-max-mb n]` and `--no-cache`, AOC_CACHE_DIR being the default
+ *        directory. Benchmarks (`--bench`) always bypass the cache.
+ */
+inline void parse_cache_args(const int argc, char** argv) {
+	const char* env_dir = std::getenv("AOC_CACHE_DIR");
+	std::string dir = env_dir ? env_dir : "";
+	uintmax_t max_mb = 256;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--cache" == arg && i + 1 < argc) {
+			dir = argv[++i];
+		} else if ("--cache-max-mb" == arg && i + 1 < argc) {
+			max_mb = std::strtoull(argv[++i], nullptr, 10);
+		} else if ("--no-cache" == arg || "--bench" == arg) {
+			dir.clear();
+			break;
+		}
+	}
+	result_cache().configure(dir, max_mb << 20);
+}
+
+// the answers of one part ("1" keeps the "Part 1 : ..." lines), or all of them
+inline std::string select_part(const std::string_view answers, const std::string_view part) {
+	if ("all" == part)
+		return std::string(answers);
+	const std::string prefix = "Part " + std::string(part) + " ";
+	std::string result;
+	std::istringstream lines{std::string(answers)};
+	for (std::string line; std::getline(lines, line);) {
+		if (line.starts_with(prefix))
+			result += line + '\n';
+	}
+	return result;
+}
+
+/**
+ * @brief The answers of part ("all", "1" or "2") by solve(input lines, out), unless a build of the same
+ *        RESULT_CACHE_VERSION has already answered that part of the same input for this day: then the
+ *        stored answers are written instead. Each part is its own entry, and only successful solves are stored.
+ */
+template <typename FSolve>
+int solve_cached(
+	const int year,
+	const int day,
+	FSolve&& solve,
+	const Input& input,
+	std::ostream& out,
+	const std::string_view part = "all") {
+	ResultCache& cache = result_cache();
+	if (!cache.enabled() && "all" == part)
+		return solve(input.lines(), out);
+
+	const uint64_t key = cache.enabled() ? cache_key(year, day, part, input.text()) : 0;
+	if (cache.enabled()) {
+		const std::optional<std::string> cached =
+			time_phase("cache_lookup", [&] { return cache.find(key, input.text().size()); });
+		if (cached) {
+			add_counter("result_cache_hits");
+			out << *cached;
+			return 0;
+		}
+	}
+
+	std::ostringstream answers;
+	const int status = solve(input.lines(), answers);
+	const std::string selected = select_part(answers.view(), part);
+	out << selected;
+	if (0 == status) {
+		cache.insert(key, input.text().size(), selected);
+	}
+	return status;
+}
+
+/**
+ * A persistent key -> int64 table, for results finer than a whole input (one machine, one range, ...).
+ * The table is one append-only file in the cache directory, loaded on first use. New entries are
+ * appended by flush() (and on destruction). Past a quarter of the cache size, the file is rewritten
+ * with only the newest half of its entries, and the table in memory is rebuilt from what is kept. A hit
+ * on an entry that has drifted an eighth of that budget from the end of the file appends it again, so
+ * the entries still in use survive the rewrite: the least recently used go first. Without a cache
+ * directory it holds nothing.
+ *
+ * Safe to share between threads (day 10 calls it from parallel_reduce workers): find, insert and flush
+ * all run under mutex_, the re-append of a hit included, so a lookup is a write and the workers take
+ * turns on it. That is cheap next to the solve each hit saves.
+ *
+ *     static ResultMemo memo("2025_10_joltage");
+ *     const uint64_t key = memo.key(machine_bytes);
+ *     if (const optional<int64_t> presses = memo.find(key)) return *presses;
+ *     ...
+ *     memo.insert(key, presses);
+ */
+class ResultMemo {
+public:
+	explicit ResultMemo(const std::string_view name) : cache_{result_cache()}, name_{name} {}
+
+	ResultMemo(const ResultMemo&) = delete;
+	ResultMemo& operator=(const ResultMemo&) = delete;
+
+	~ResultMemo() { flush(); }
+
+	bool enabled() const { return cache_.enabled(); }
+
+	uint64_t key(const std::string_view bytes) const {
+		return hash_bytes(bytes, hash_bytes(name_, cache_version_salt()));
+	}
+
+	// also moves a hit to the end of the file when it has drifted, under mutex_ like the lookup
+	std::optional<int64_t> find(const uint64_t key) {
+		if (!cache_.enabled())
+			return std::nullopt;
+		std::lock_guard<std::mutex> lock(mutex_);
+		load();
+		const auto it = values_.find(key);
+		if (values_.end() == it)
+			return std::nullopt;
+		Entry& entry = it->second;
+		if (entry.position + max_records() / 8 < n_records_) {
+			// appended again, so that the next compact() sees it as recently used
+			pending_.push_back(Record{key, entry.value});
+			entry.position = n_records_++;
+		}
+		return entry.value;
+	}
+
+	void insert(const uint64_t key, const int64_t value) {
+		if (!cache_.enabled())
+			return;
+		std::lock_guard<std::mutex> lock(mutex_);
+		load();
+		if (values_.emplace(key, Entry{value, n_records_}).second) {
+			pending_.push_back(Record{key, value});
+			++n_records_;
+		}
+	}
+
+	void flush() {
+		if (!cache_.enabled())
+			return;
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (pending_.empty())
+			return;
+		{
+			std::ofstream file(path(), std::ios::binary | std::ios::app);
+			file.write(reinterpret_cast<const char*>(pending_.data()), pending_.size() * sizeof(Record));
+		}
+		pending_.clear();
+
+		std::error_code error;
+		const uintmax_t size = std::filesystem::file_size(path(), error);
+		if (!error && size > max_records() * sizeof(Record)) {
+			compact(size / sizeof(Record));
+		}
+	}
+
+private:
+	struct Record {
+		uint64_t key;
+		int64_t value;
+	};
+
+	struct Entry {
+		int64_t value;
+		size_t position; // of its newest record in the file, pending ones included
+	};
+
+	// the budget of the file, a quarter of the cache size
+	size_t max_records() const { return cache_.max_bytes() / 4 / sizeof(Record); }
+
+	std::filesystem::path path() const { return cache_.dir() / (name_ + ".memo"); }
+
+	std::vector<Record> read_records() const {
+		std::vector<Record> records;
+		std::ifstream file(path(), std::ios::binary);
+		Record record;
+		while (file.read(reinterpret_cast<char*>(&record), sizeof(Record))) {
+			records.push_back(record);
+		}
+		return records;
+	}
+
+	void load() {
+		if (loaded_)
+			return;
+		loaded_ = true;
+		for (const Record& record : read_records()) {
+			values_.insert_or_assign(record.key, Entry{record.value, n_records_++});
+		}
+	}
+
+	// keeps the newest half of the records, the ones at the end of the file, once each
+	void compact(const size_t n_records) {
+		const std::vector<Record> records = read_records();
+		const size_t keep = n_records / 2;
+		std::vector<Record> kept;
+		std::unordered_map<uint64_t, Entry> kept_values;
+		for (auto it = records.rbegin(); records.rend() != it && kept.size() < keep; ++it) {
+			if (kept_values.emplace(it->key, Entry{it->value, 0}).second)
+				kept.push_back(*it);
+		}
+		std::reverse(kept.begin(), kept.end());
+		for (size_t i = 0; i < kept.size(); ++i) {
+			kept_values[kept[i].key].position = i;
+		}
+		values_ = std::move(kept_values);
+		n_records_ = kept.size();
+
+		std::filesystem::path temp = path();
+		temp += ".tmp";
+		{
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(kept.data()), kept.size() * sizeof(Record));
+		}
+		std::error_code error;
+		std::filesystem::rename(temp, path(), error);
+	}
+
+	ResultCache& cache_;
+	std::string name_;
+	std::mutex mutex_;
+	bool loaded_ = false;
+	std::unordered_map<uint64_t, Entry> values_; // only what the file holds, so bounded like it
+	size_t n_records_ = 0;						 // in the file, pending ones included
+	std::vector<Record> pending_;
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Structural indexing, in the spirit of simdjson's first stage.
+ *
+ * Rather than calling find() over and over on every line, the whole buffer is classified
+ * 64 bytes at a time into two bitmasks: newlines and "any byte of the delimiter set".
+ * The set bits are then walked in order, so the positions come out already sorted.
+ *
+ * Classification uses AVX2 when compiled with -mavx2 (or -march=native), SSE2 on any other
+ * x86-64, and a lookup table everywhere else.
+ */
+
+constexpr size_t STRUCTURAL_BLOCK_SIZE = 64;
+constexpr size_t STRUCTURAL_MAX_DELIMITERS = 8;
+
+struct StructuralMasks {
+	uint64_t newlines;
+	uint64_t delimiters;
+};
+
+class StructuralClassifier {
+public:
+	explicit StructuralClassifier(const std::string_view delimiter_set) : count_{delimiter_set.size()} {
+		if (count_ > STRUCTURAL_MAX_DELIMITERS) {
+			throw std::invalid_argument("Too many delimiters=" + std::string(delimiter_set));
+		}
+		table_.fill(0);
+		table_[static_cast<unsigned char>('\n')] = NEWLINE;
+		for (size_t i = 0; i < count_; ++i) {
+			if ('\n' == delimiter_set[i]) {
+				throw std::invalid_argument("Newline is always indexed, it cannot be a delimiter");
+			}
+			delimiters_[i] = delimiter_set[i];
+			table_[static_cast<unsigned char>(delimiter_set[i])] |= DELIMITER;
+		}
+	}
+
+	// classify exactly STRUCTURAL_BLOCK_SIZE bytes starting at block
+	StructuralMasks classify(const char* block) const {
+#if defined(__AVX2__)
+		const __m256i newline = _mm256_set1_epi8('\n');
+		const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+		const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+		__m256i delim_lo = _mm256_setzero_si256();
+		__m256i delim_hi = _mm256_setzero_si256();
+		for (size_t i = 0; i < count_; ++i) {
+			const __m256i d = _mm256_set1_epi8(delimiters_[i]);
+			delim_lo = _mm256_or_si256(delim_lo, _mm256_cmpeq_epi8(lo, d));
+			delim_hi = _mm256_or_si256(delim_hi, _mm256_cmpeq_epi8(hi, d));
+		}
+		return {
+			join_32(
+				_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)),
+				_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline))),
+			join_32(_mm256_movemask_epi8(delim_lo), _mm256_movemask_epi8(delim_hi))};
+#elif defined(__SSE2__)
+		const __m128i newline = _mm_set1_epi8('\n');
+		StructuralMasks result{0, 0};
+		for (size_t lane = 0; lane < 4; ++lane) {
+			const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * lane));
+			__m128i delim = _mm_setzero_si128();
+			for (size_t i = 0; i < count_; ++i) {
+				delim = _mm_or_si128(delim, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(delimiters_[i])));
+			}
+			const uint64_t newline_bits =
+				static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+			const uint64_t delim_bits = static_cast<uint16_t>(_mm_movemask_epi8(delim));
+			result.newlines |= newline_bits << (16 * lane);
+			result.delimiters |= delim_bits << (16 * lane);
+		}
+		return result;
+#else
+		return classify_scalar(block, STRUCTURAL_BLOCK_SIZE);
+#endif
+	}
+
+	// lookup table classification of up to STRUCTURAL_BLOCK_SIZE bytes. Used for the tail.
+	StructuralMasks classify_scalar(const char* block, const size_t size) const {
+		StructuralMasks result{0, 0};
+		for (size_t i = 0; i < size; ++i) {
+			const uint8_t kind = table_[static_cast<unsigned char>(block[i])];
+			result.newlines |= static_cast<uint64_t>(kind & NEWLINE) << i;
+			result.delimiters |= static_cast<uint64_t>((kind & DELIMITER) >> 1) << i;
+		}
+		return result;
+	}
+
+private:
+	static constexpr uint8_t NEWLINE = 1;
+	static constexpr uint8_t DELIMITER = 2;
+
+	static uint64_t join_32(const int lo, const int hi) {
+		return static_cast<uint32_t>(lo) | (static_cast<uint64_t>(static_cast<uint32_t>(hi)) << 32);
+	}
+
+	size_t count_;
+	std::array<char, STRUCTURAL_MAX_DELIMITERS> delimiters_{};
+	std::array<uint8_t, 256> table_;
+};
+
+/**
+ * @brief Single pass over text. Calls on_newline(offset) and on_delimiter(offset) for every
+ *        structural byte, in increasing offset order.
+ */
+template <typename FNewline, typename FDelimiter>
+void scan_structural(
+	const std::string_view text,
+	const std::string_view delimiter_set,
+	FNewline&& on_newline,
+	FDelimiter&& on_delimiter) {
+	const StructuralClassifier classifier(delimiter_set);
+	const char* const data = text.data();
+	const size_t n = text.size();
+
+	auto emit = [&](const size_t base, const StructuralMasks masks) {
+		uint64_t all = masks.newlines | masks.delimiters;
+		while (all) {
+			const int bit = std::countr_zero(all);
+			if ((masks.newlines >> bit) & 1) {
+				on_newline(base + bit);
+			} else {
+				on_delimiter(base + bit);
+			}
+			all &= all - 1; // clear lowest set bit
+		}
+	};
+
+	size_t base = 0;
+	for (; base + STRUCTURAL_BLOCK_SIZE <= n; base += STRUCTURAL_BLOCK_SIZE) {
+		emit(base, classifier.classify(data + base));
+	}
+	if (base < n) {
+		emit(base, classifier.classify_scalar(data + base, n - base));
+	}
+}
+
+/**
+ * @brief Offsets table for a set of lines.
+ *
+ *        newlines holds the offset of every '\n' in the scanned text. Delimiter offsets are
+ *        relative to the start of their own line, so they index straight into lines[i].
+ *        The delimiters of line i are delimiters[line_delimiters[i], line_delimiters[i + 1]).
+ */
+struct StructuralIndex {
+	std::vector<uint32_t> newlines;
+	std::vector<uint32_t> delimiters;
+	std::vector<uint32_t> line_delimiters;
+
+	std::span<const uint32_t> delimiters_in_line(const size_t line) const {
+		return std::span<const uint32_t>(delimiters)
+			.subspan(line_delimiters[line], line_delimiters[line + 1] - line_delimiters[line]);
+	}
+};
+
+/**
+ * @brief Index the delimiters of lines that come from one Input (ie. views into a single
+ *        buffer separated by '\n'). The buffer is scanned once, from the first line to the end of
+ *        the last one.
+ */
+inline void build_structural_index(
+	StructuralIndex& result,
+	const std::vector<std::string_view>& lines,
+	const std::string_view delimiter_set) {
+	result.newlines.clear();
+	result.delimiters.clear();
+	result.line_delimiters.clear();
+	if (lines.empty()) {
+		result.line_delimiters.push_back(0);
+		return;
+	}
+
+	const char* const begin = lines.front().data();
+	const char* const end = lines.back().data() + lines.back().size();
+	if (end - begin > UINT32_MAX) {
+		throw std::runtime_error("Input too large for 32 bit offsets");
+	}
+	result.line_delimiters.reserve(lines.size() + 1);
+	result.line_delimiters.push_back(0);
+
+	size_t line = 0;
+	size_t line_start = 0;
+	scan_structural(
+		std::string_view(begin, end - begin),
+		delimiter_set,
+		[&](const size_t offset) {
+			if (line + 1 >= lines.size() || begin + offset != lines[line].data() + lines[line].size()) {
+				throw std::runtime_error("Lines are not contiguous views of one buffer");
+			}
+			result.newlines.push_back(offset);
+			result.line_delimiters.push_back(result.delimiters.size());
+			++line;
+			line_start = offset + 1;
+		},
+		[&](const size_t offset) { result.delimiters.push_back(offset - line_start); });
+	result.line_delimiters.push_back(result.delimiters.size());
+
+	if (line + 1 != lines.size()) {
+		throw std::runtime_error("Lines are not contiguous views of one buffer");
+	}
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "threads.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * A work-stealing thread pool.
+ *
+ * Every worker owns a deque. A task submitted from a worker goes to the back of its own deque
+ * (it is likely to share data with the task that spawned it), other tasks are dealt round robin.
+ * A worker runs its own tasks newest first and, once it runs out, steals the oldest task of
+ * another worker.
+ *
+ * Tasks must not throw, catch inside the task and hand the error back with its result.
+ *
+ * wait() blocks until every submitted task has finished. Called from a worker, it runs tasks
+ * while it waits instead of blocking the worker. A task that waits for the tasks it spawned uses
+ * a TaskGroup instead, as wait() would also count the waiting task itself.
+ */
+class ThreadPool {
+public:
+	using Task = std::function<void()>;
+
+	explicit ThreadPool(const size_t n_threads = thread_count()) {
+		const size_t n = n_threads ? n_threads : 1;
+		for (size_t i = 0; i < n; ++i) {
+			workers_.push_back(std::make_unique<Worker>());
+		}
+		for (size_t i = 0; i < n; ++i) {
+			threads_.emplace_back([this, i] { run(i); });
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// finishes the tasks already submitted
+	~ThreadPool() {
+		wait();
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_all();
+		for (std::thread& thread : threads_) {
+			thread.join();
+		}
+	}
+
+	size_t size() const { return workers_.size(); }
+
+	void submit(Task task) {
+		const size_t self = current_worker();
+		const size_t target = self < size() ? self : next_++ % size();
+		{
+			// counted before it can run, so that pending_ never goes below 0
+			std::lock_guard<std::mutex> lock(mutex_);
+			++pending_;
+		}
+		{
+			std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+			workers_[target]->tasks.push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			++queued_;
+		}
+		wake_.notify_one();
+	}
+
+	void wait() {
+		const size_t self = current_worker();
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (0 != pending_) {
+			if (self < size()) {
+				// help instead of blocking a worker, or nested waits could deadlock the pool
+				lock.unlock();
+				Task task;
+				if (try_pop(self, task)) {
+					execute(task);
+				} else {
+					std::this_thread::yield();
+				}
+				lock.lock();
+			} else {
+				idle_.wait(lock, [this] { return 0 == pending_; });
+			}
+		}
+	}
+
+	/**
+	 * @brief Blocks until done() holds, done() turning true as tasks finish. Like wait(), a worker
+	 *        runs tasks while it waits.
+	 */
+	template <typename FDone>
+	void wait_until(FDone&& done) {
+		const size_t self = current_worker();
+		if (self < size()) {
+			while (!done()) {
+				Task task;
+				if (try_pop(self, task)) {
+					execute(task);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+			return;
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		idle_.wait(lock, [&done] { return done(); });
+	}
+
+	// the index of the calling worker of this pool, or size() when called from any other thread
+	size_t current_worker() const { return this == current_pool() ? current_index() : size(); }
+
+private:
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	static const ThreadPool*& current_pool() {
+		thread_local const ThreadPool* pool = nullptr;
+		return pool;
+	}
+
+	static size_t& current_index() {
+		thread_local size_t index = 0;
+		return index;
+	}
+
+	// own tasks newest first, then the oldest task of the other workers
+	bool try_pop(const size_t self, Task& task) {
+		{
+			Worker& own = *workers_[self];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				return taken();
+			}
+		}
+		for (size_t k = 1; k < size(); ++k) {
+			Worker& victim = *workers_[(self + k) % size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty()) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return taken();
+			}
+		}
+		return false;
+	}
+
+	bool taken() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		--queued_;
+		return true;
+	}
+
+	void execute(Task& task) {
+		task();
+		std::lock_guard<std::mutex> lock(mutex_);
+		--pending_;
+		idle_.notify_all();
+	}
+
+	void run(const size_t index) {
+		current_pool() = this;
+		current_index() = index;
+		while (true) {
+			Task task;
+			if (try_pop(index, task)) {
+				execute(task);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(mutex_);
+			wake_.wait(lock, [this] { return stop_ || 0 != queued_; });
+			if (stop_ && 0 == queued_)
+				return;
+		}
+	}
+
+	std::vector<std::unique_ptr<Worker>> workers_;
+	std::vector<std::thread> threads_;
+	std::atomic<size_t> next_{0}; // round robin target for tasks from outside the pool
+
+	std::mutex mutex_;
+	std::condition_variable wake_; // a task was queued, or the pool stops
+	std::condition_variable idle_; // a task has finished
+	size_t queued_ = 0;			   // in the deques
+	size_t pending_ = 0;		   // submitted and not finished
+	bool stop_ = false;
+};
+
+// the shared pool, started lazily and restarted when the thread count changes
+struct SharedThreadPool {
+	std::mutex mutex;
+	std::unique_ptr<ThreadPool> pool;
+};
+
+inline SharedThreadPool& shared_thread_pool_state() {
+	static SharedThreadPool state;
+	return state;
+}
+
+// the pool shared by the whole process, started on first use with thread_count() threads
+inline ThreadPool& shared_thread_pool() {
+	SharedThreadPool& state = shared_thread_pool_state();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	std::unique_ptr<ThreadPool>& pool = state.pool;
+	if (!pool)
+		pool = std::make_unique<ThreadPool>(thread_count());
+	return *pool;
+}
+
+/**
+ * @brief Restarts the shared pool with thread_count() threads once set_thread_count() changed it,
+ *        as a bench sweep does between points. Only between runs: nothing may be queued on the pool
+ *        or hold a reference to it.
+ */
+inline void restart_shared_thread_pool() {
+	SharedThreadPool& state = shared_thread_pool_state();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	std::unique_ptr<ThreadPool>& pool = state.pool;
+	if (pool && pool->size() != thread_count()) {
+		pool.reset(); // joins the old workers before the new ones start
+		pool = std::make_unique<ThreadPool>(thread_count());
+	}
+}
+
+/**
+ * A set of tasks to wait for together, on a pool that may be busy with other work (a batch input
+ * that fans out its parts, say). Unlike pool tasks, these may throw: wait() rethrows the first error.
+ *
+ *     TaskGroup group;
+ *     group.run([&] { a = part_1(model); });
+ *     b = part_2(model);
+ *     group.wait();
+ */
+class TaskGroup {
+public:
+	explicit TaskGroup(ThreadPool& pool = shared_thread_pool()) : pool_{pool} {}
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+	// the tasks reference the group, so it outlives them even when wait() is skipped by an exception
+	~TaskGroup() {
+		pool_.wait_until([this] { return 0 == remaining_.load(std::memory_order_acquire); });
+	}
+
+	void run(std::function<void()> task) {
+		remaining_.fetch_add(1, std::memory_order_relaxed);
+		pool_.submit([this, task = std::move(task)] {
+			try {
+				task();
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(error_mutex_);
+				if (!error_)
+					error_ = std::current_exception();
+			}
+			remaining_.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	void wait() {
+		pool_.wait_until([this] { return 0 == remaining_.load(std::memory_order_acquire); });
+		std::lock_guard<std::mutex> lock(error_mutex_);
+		if (error_)
+			std::rethrow_exception(std::exchange(error_, nullptr));
+	}
+
+private:
+	ThreadPool& pool_;
+	std::atomic<size_t> remaining_{0};
+	std::mutex error_mutex_;
+	std::exception_ptr error_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+
+/**
+ * The process wide thread-count knob. Solvers that go parallel size their work by thread_count(),
+ * and the benchmark sweep sets it for each point of a scaling curve.
+ * 0 (the default) means one thread per hardware thread.
+ */
+
+inline size_t& thread_count_setting() {
+	static size_t setting = 0;
+	return setting;
+}
+
+inline void set_thread_count(const size_t n) { thread_count_setting() = n; }
+
+inline size_t thread_count() {
+	const size_t setting = thread_count_setting();
+	if (0 != setting)
+		return setting;
+	const size_t hardware = std::thread::hardware_concurrency();
+	return 0 == hardware ? 1 : hardware;
+}
+
+// `--threads n`, the bench sweep's `--threads 1,2,4` list is left to parse_bench_args
+inline void parse_thread_args(const int argc, char** argv) {
+	for (int i = 1; i + 1 < argc; ++i) {
+		const std::string_view value = argv[i + 1];
+		if (std::string_view("--threads") == argv[i] && std::string_view::npos == value.find(',')) {
+			set_thread_count(std::strtoull(argv[i + 1], nullptr, 10));
+		}
+	}
+}
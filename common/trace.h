@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Timeline export in the Chrome trace event format, opt-in with `--trace <path>`.
+ *
+ * Every ScopedPhase becomes a complete ("X") event, and so does every ScopedTask, which marks one
+ * unit of work of a solver (a machine, a range, ...) on whichever thread runs it. Load the file in
+ * https://ui.perfetto.dev or chrome://tracing to see stragglers and idle threads.
+ *
+ * Tracing off costs a single branch per phase or task. Tracing on takes a lock per event, so keep
+ * tasks at the granularity of a machine or a range, not of an inner loop iteration.
+ */
+
+struct TraceEvent {
+	std::string name;
+	const char* category; // "phase" or "task"
+	uint32_t tid;
+	int64_t index; // the task index, -1 for none
+	double start_us;
+	double duration_us;
+};
+
+// threads are numbered in the order they first record something, the main thread is normally 0
+inline uint32_t trace_thread_id() {
+	static std::atomic<uint32_t> next{0};
+	thread_local const uint32_t id = next++;
+	return id;
+}
+
+class TraceRecorder {
+public:
+	TraceRecorder() : origin_{std::chrono::steady_clock::now()} {}
+
+	bool enabled() const { return enabled_; }
+	const std::string& path() const { return path_; }
+
+	void enable(std::string path) {
+		path_ = std::move(path);
+		enabled_ = true;
+	}
+
+	// microseconds since the recorder was created
+	double now_us() const {
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin_).count();
+	}
+
+	void record(TraceEvent event) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		events_.push_back(std::move(event));
+	}
+
+	void write_json(std::ostream& os) const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		uint32_t n_threads = 0;
+		for (const TraceEvent& event : events_) {
+			n_threads = std::max(n_threads, event.tid + 1);
+		}
+
+		os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		for (uint32_t tid = 0; tid < n_threads; ++tid) {
+			const std::string name = 0 == tid ? std::string("main") : "worker " + std::to_string(tid);
+			os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+			   << ",\"args\":{\"name\":\"" << name << "\"}},\n";
+		}
+		for (size_t i = 0; i < events_.size(); ++i) {
+			const TraceEvent& event = events_[i];
+			os << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+			   << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.tid << ",\"ts\":" << event.start_us
+			   << ",\"dur\":" << event.duration_us;
+			if (event.index >= 0) {
+				os << ",\"args\":{\"index\":" << event.index << "}";
+			}
+			os << "}" << (i + 1 < events_.size() ? ",\n" : "\n");
+		}
+		os << "]}\n";
+	}
+
+	// writes to the `--trace` path, if tracing
+	bool write() const {
+		if (!enabled_)
+			return true;
+		std::ofstream file(path_);
+		write_json(file);
+		if (!file) {
+			std::cerr << "Cannot write trace path=" << path_ << "\n";
+			return false;
+		}
+		return true;
+	}
+
+private:
+	std::chrono::steady_clock::time_point origin_;
+	bool enabled_ = false;
+	std::string path_;
+
+	mutable std::mutex mutex_;
+	std::vector<TraceEvent> events_;
+};
+
+inline TraceRecorder& trace_recorder() {
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+inline bool tracing_enabled() { return trace_recorder().enabled(); }
+
+/**
+ * @brief One unit of work of a solver, e.g. a machine of day 10. Only shows up in the trace,
+ *        the phase report stays one entry per phase.
+ */
+class ScopedTask {
+public:
+	explicit ScopedTask(const char* name, const int64_t index = -1)
+		: name_{name}, index_{index}, start_us_{tracing_enabled() ? trace_recorder().now_us() : 0.0} {}
+
+	ScopedTask(const ScopedTask&) = delete;
+	ScopedTask& operator=(const ScopedTask&) = delete;
+
+	~ScopedTask() {
+		if (!tracing_enabled())
+			return;
+		TraceRecorder& recorder = trace_recorder();
+		const double end_us = recorder.now_us();
+		recorder.record(TraceEvent{name_, "task", trace_thread_id(), index_, start_us_, end_us - start_us_});
+	}
+
+private:
+	const char* name_;
+	int64_t index_;
+	double start_us_;
+};
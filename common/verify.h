@@ -0,0 +1,178 @@
+#pragma once
+
+#include "bench.h"
+#include "generate.h"
+#include "input.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Differential checks of the optimised solvers against the straightforward ones they replaced.
+ *
+ * When a day gets a fast path, the original function stays as its reference, and the day's verify()
+ * registers the pair: both are run on the same input, their results must be equal, and both are
+ * timed (best of a few runs), so the report also gives the speedup of each pair.
+ *
+ *     verifier.check("part_1", [&] { return reference(lines); }, [&] { return optimised(lines); });
+ *
+ * `--verify` runs every pair on the real input (stdin, unless it is a terminal) and on generated
+ * inputs, `seeds` of them at every size. Any mismatch is printed with both values, and fails the run.
+ *
+ *     ./build/day.tsk --verify [--sizes 10,100,1000] [--seeds 3] [--seed s] < ./io/input1.txt
+ *     ./build/aoc.tsk 2025 all --verify --input-dir ./io/2025
+ */
+
+struct VerifyOptions {
+	std::vector<size_t> sizes{10, 100, 1000};
+	size_t n_seeds = 3;
+	uint64_t seed = 2025;
+	size_t repetitions = 3; // timed runs of each side, the best one is kept
+};
+
+struct VerifyResult {
+	std::string name;
+	std::string input;
+	bool match;
+	double reference_seconds;
+	double optimized_seconds;
+};
+
+class Verifier {
+public:
+	explicit Verifier(const VerifyOptions& options) : options_{options} {}
+
+	// the label of the input the next checks run on, e.g. "input" or "gen_1000_s2025"
+	void set_input(const std::string& label) { input_ = label; }
+
+	/**
+	 * @brief Runs reference() and optimized(), which must return equal results (compared with ==, and
+	 *        printable with << for the mismatch message).
+	 */
+	template <typename FReference, typename FOptimized>
+	void check(const std::string& name, FReference&& reference, FOptimized&& optimized) {
+		const auto [expected, reference_seconds] = time_best(reference);
+		const auto [actual, optimized_seconds] = time_best(optimized);
+		const bool match = expected == actual;
+		if (!match) {
+			std::cerr << "MISMATCH verify=" << name << " input=" << input_ << " reference=" << expected
+					  << " optimized=" << actual << "\n";
+		}
+		results_.push_back(VerifyResult{name, input_, match, reference_seconds, optimized_seconds});
+	}
+
+	const std::vector<VerifyResult>& results() const { return results_; }
+
+	bool failed() const {
+		return std::any_of(results_.begin(), results_.end(), [](const VerifyResult& r) { return !r.match; });
+	}
+
+	void report(std::ostream& os) const {
+		os << std::left << std::setw(16) << "verify" << std::setw(20) << "input" << std::setw(10)
+		   << "result" << std::right << std::setw(14) << "reference_us" << std::setw(14) << "optimized_us"
+		   << std::setw(10) << "speedup"
+		   << "\n";
+		for (const VerifyResult& result : results_) {
+			os << std::left << std::setw(16) << result.name << std::setw(20) << result.input << std::setw(10)
+			   << (result.match ? "ok" : "MISMATCH") << std::right << std::fixed << std::setprecision(2)
+			   << std::setw(14) << result.reference_seconds * 1e6 << std::setw(14)
+			   << result.optimized_seconds * 1e6;
+			if (result.optimized_seconds > 0.0) {
+				os << std::setw(9) << result.reference_seconds / result.optimized_seconds << "x";
+			}
+			os << std::defaultfloat << "\n";
+		}
+	}
+
+private:
+	template <typename F>
+	auto time_best(F&& func) const {
+		auto value = func();
+		double best = 0.0;
+		for (size_t i = 0; i < std::max<size_t>(1, options_.repetitions); ++i) {
+			const auto start = std::chrono::steady_clock::now();
+			do_not_optimize(func());
+			const double seconds =
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			best = 0 == i ? seconds : std::min(best, seconds);
+		}
+		return std::make_pair(std::move(value), best);
+	}
+
+	VerifyOptions options_;
+	std::string input_ = "input";
+	std::vector<VerifyResult> results_;
+};
+
+/**
+ * @brief Parses `--verify [--sizes list] [--seeds n] [--seed s]`.
+ * @return whether verifying was requested
+ */
+inline bool parse_verify_args(VerifyOptions& options, const int argc, char** argv) {
+	bool requested = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if ("--verify" == arg) {
+			requested = true;
+		} else if ("--sizes" == arg && i + 1 < argc) {
+			options.sizes = parse_size_list(argv[++i]);
+		} else if ("--seeds" == arg && i + 1 < argc) {
+			options.n_seeds = std::strtoull(argv[++i], nullptr, 10);
+		} else if ("--seed" == arg && i + 1 < argc) {
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+	}
+	return requested;
+}
+
+/**
+ * @brief Runs the pairs that verify(verifier, lines) checks, on the real input if there is one
+ *        (input may be nullptr or empty) and then on the generated inputs, and prints the report.
+ */
+template <typename FVerify, typename FGenerate>
+int run_verification(
+	const VerifyOptions& options,
+	const Input* input,
+	FVerify&& verify,
+	FGenerate&& generate,
+	std::ostream& os) {
+	Verifier verifier(options);
+	// an empty stdin (CI, `< /dev/null`) is no input at all, the solvers expect at least one line
+	if (input && input->text().empty()) {
+		std::cerr << "--verify : the input is empty, checking the generated inputs only\n";
+		input = nullptr;
+	}
+	if (input) {
+		verifier.set_input("input");
+		verify(verifier, input->lines());
+	}
+	for (const size_t size : options.sizes) {
+		for (size_t s = 0; s < options.n_seeds; ++s) {
+			const uint64_t seed = options.seed + s;
+			const Input generated = Input::from_string(generate_to_string(generate, size, seed));
+			verifier.set_input("gen_" + std::to_string(size) + "_s" + std::to_string(seed));
+			verify(verifier, generated.lines());
+		}
+	}
+	verifier.report(os);
+	return verifier.failed() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// for a day's own main: the real input is stdin, unless stdin is a terminal
+template <typename FVerify, typename FGenerate>
+int run_verification(const VerifyOptions& options, FVerify&& verify, FGenerate&& generate) {
+	if (isatty(STDIN_FILENO)) {
+		return run_verification(options, nullptr, verify, generate, std::cout);
+	}
+	const Input input = Input::from_stdin();
+	return run_verification(options, &input, verify, generate, std::cout);
+}
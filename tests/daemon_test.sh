@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+# Checks that a request the daemon cannot solve is answered with an error, and that the daemon is still
+# serving afterwards. Run from the repo root: ./tests/daemon_test.sh
+set -euo pipefail
+
+build=./build
+socket=$(mktemp -u /tmp/aoc_test.XXXXXX.sock)
+mkdir -p "$build"
+g++ -std=c++23 -O2 aoc.cpp -o "$build/aoc.tsk"
+g++ -std=c++23 -O2 aoc_client.cpp -o "$build/aoc_client.tsk"
+
+"$build/aoc.tsk" --serve "$socket" --handlers 2 &
+daemon=$!
+trap 'kill $daemon 2>/dev/null || true; rm -f "$socket"' EXIT
+for _ in $(seq 50); do
+	[ -S "$socket" ] && break
+	sleep 0.1
+done
+
+fail() {
+	echo "FAIL: $1"
+	exit 1
+}
+
+# every day, with nothing and with only blank lines
+for day in $(seq 1 10); do
+	for input in "" $'\n\n'; do
+		response=$(printf '%s' "$input" | "$build/aoc_client.tsk" --socket "$socket" 2025 "$day" || true)
+		[[ "$response" == '{"status":"error","error":"Empty input'* ]] ||
+			fail "day $day, empty input: $response"
+	done
+done
+
+# and a real request still gets its answers
+response=$(printf '..S..\n.....\n..^..\n' | "$build/aoc_client.tsk" --socket "$socket" 2025 7)
+[[ "$response" == '{"status":"ok"'* ]] || fail "day 7 after the empty inputs: $response"
+
+"$build/aoc_client.tsk" --socket "$socket" --shutdown > /dev/null
+wait $daemon || fail "the daemon exited with status $?"
+echo "OK"